@@ -6,6 +6,7 @@
 #include <tuple>
 #include <glad/glad.h>
 #include <cctype>
+#include <cstring>
 #include <memory>
 
 #if defined(OS_WINDOWS)
@@ -178,6 +179,27 @@ size_t hashString(const std::string& str) {
     return hash;
 }
 
+uint64_t hashBytes(const void* data, size_t size) {
+    // 8 bytes per step with a multiply/xorshift mix, finishes the tail bytewise
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint64_t hash = 0xcbf29ce484222325 ^ (size * 0x9e3779b97f4a7c15);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t k;
+        std::memcpy(&k, p + i, 8);
+        k *= 0xff51afd7ed558ccd;
+        k ^= k >> 33;
+        hash = (hash ^ k) * 0xc4ceb9fe1a85ec53;
+        hash ^= hash >> 29;
+    }
+    for (; i < size; ++i) {
+        hash ^= p[i];
+        hash *= 0x100000001b3;
+    }
+    hash ^= hash >> 32;
+    return hash;
+}
+
 // GL
 std::tuple<GLfloat, GLfloat> screenToGLCoords(int x, int y, int screenW, int screenH) {
     float glX = (2.0f * x) / screenW - 1.0f;
@@ -3,6 +3,7 @@
 #pragma once
 
 #include <stdio.h>
+#include <cstdint>
 #include <iostream>
 #include <string>
 #include <SDL3/SDL.h>
@@ -36,6 +37,8 @@ std::string trim(const std::string& str);
 std::vector<std::string> split(const std::string& str, char delimiter);
 std::string replaceAll(const std::string& str, const std::string& from, const std::string& to);
 size_t hashString(const std::string& str);
+// fast 64-bit hash for big binary blobs (decoded pixels etc.), not cryptographic
+uint64_t hashBytes(const void* data, size_t size);
 
 // Functions for use with OpenGL and whatnot
 // basically 640, 360 = 0.5, 0.5
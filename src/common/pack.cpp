@@ -0,0 +1,205 @@
+#include "pack.hpp"
+
+#include <miniz.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace Common {
+
+namespace {
+
+constexpr char PACK_MAGIC[8] = { 'F', 'N', '3', 'P', 'A', 'C', 'K', '\0' };
+
+bool entryLess(const Pack::Entry& a, const Pack::Entry& b) {
+    if (a.type != b.type) return a.type < b.type;
+    return a.id < b.id;
+}
+
+uint64_t alignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+} // namespace
+
+bool Pack::open(const std::string& path) {
+    close();
+    if (!m_file.open(path)) return false;
+
+    const unsigned char* base = m_file.data();
+    size_t fileSize = m_file.size();
+
+    Header header;
+    if (fileSize < sizeof(header)) {
+        close();
+        return false;
+    }
+    std::memcpy(&header, base, sizeof(header));
+
+    uint64_t indexBytes = (uint64_t)header.entryCount * sizeof(Entry);
+    if (std::memcmp(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0 ||
+        header.version != VERSION ||
+        header.indexOffset % alignof(Entry) != 0 ||
+        header.namesOffset > header.indexOffset ||
+        header.indexOffset + indexBytes != fileSize) {
+        close();
+        return false;
+    }
+
+    m_index = reinterpret_cast<const Entry*>(base + header.indexOffset);
+    m_count = header.entryCount;
+    m_names = reinterpret_cast<const char*>(base + header.namesOffset);
+    m_namesSize = header.indexOffset - header.namesOffset;
+
+    for (uint32_t i = 0; i < m_count; ++i) {
+        const Entry& entry = m_index[i];
+        if (entry.offset + entry.storedSize > header.namesOffset || entry.nameOffset >= m_namesSize) {
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void Pack::close() {
+    m_file.close();
+    m_index = nullptr;
+    m_count = 0;
+    m_names = nullptr;
+    m_namesSize = 0;
+}
+
+const Pack::Entry* Pack::find(Type type, int id) const {
+    if (!m_index) return nullptr;
+
+    Entry probe{};
+    probe.type = type;
+    probe.id = id;
+    const Entry* it = std::lower_bound(m_index, m_index + m_count, probe, entryLess);
+    if (it == m_index + m_count || it->type != type || it->id != id) return nullptr;
+    return it;
+}
+
+const Pack::Entry* Pack::begin(Type type) const {
+    if (!m_index) return nullptr;
+    return std::lower_bound(m_index, m_index + m_count, type,
+        [](const Entry& entry, Type t) { return entry.type < t; });
+}
+
+const Pack::Entry* Pack::end(Type type) const {
+    if (!m_index) return nullptr;
+    return std::upper_bound(m_index, m_index + m_count, type,
+        [](Type t, const Entry& entry) { return t < entry.type; });
+}
+
+std::string_view Pack::name(const Entry& entry) const {
+    if (!m_names || entry.nameOffset >= m_namesSize) return {};
+    return std::string_view(m_names + entry.nameOffset);
+}
+
+bool Pack::read(const Entry& entry, const unsigned char*& data, size_t& size, std::vector<unsigned char>& scratch) const {
+    if (!m_index) return false;
+    const unsigned char* stored = m_file.data() + entry.offset;
+
+    if (entry.method == Method::Stored) {
+        data = stored;
+        size = (size_t)entry.size;
+        return true;
+    }
+
+    if (entry.method != Method::Deflated) return false;
+
+    scratch.resize((size_t)entry.size);
+    mz_ulong outSize = (mz_ulong)entry.size;
+    if (mz_uncompress(scratch.data(), &outSize, stored, (mz_ulong)entry.storedSize) != MZ_OK || outSize != entry.size) {
+        return false;
+    }
+    data = scratch.data();
+    size = (size_t)entry.size;
+    return true;
+}
+
+void PackWriter::add(Pack::Type type, int id, const std::string& name, int64_t sourceTime,
+    const std::vector<unsigned char>& data, bool tryDeflate) {
+    Pending pending;
+    pending.entry = {};
+    pending.entry.type = type;
+    pending.entry.id = id;
+    pending.entry.method = Pack::Method::Stored;
+    pending.entry.sourceTime = sourceTime;
+    pending.entry.size = data.size();
+    pending.name = name;
+
+    if (tryDeflate && !data.empty()) {
+        mz_ulong bound = mz_compressBound((mz_ulong)data.size());
+        std::vector<unsigned char> packed(bound);
+        mz_ulong packedSize = bound;
+        // not worth an inflate on load unless it saves at least ~10%
+        if (mz_compress2(packed.data(), &packedSize, data.data(), (mz_ulong)data.size(), MZ_BEST_COMPRESSION) == MZ_OK &&
+            packedSize < data.size() - data.size() / 10) {
+            packed.resize(packedSize);
+            pending.entry.method = Pack::Method::Deflated;
+            pending.data = std::move(packed);
+        }
+    }
+    if (pending.entry.method == Pack::Method::Stored) pending.data = data;
+
+    pending.entry.storedSize = pending.data.size();
+    m_rawBytes += data.size();
+    m_storedBytes += pending.data.size();
+    m_entries.push_back(std::move(pending));
+}
+
+bool PackWriter::write(const std::string& path) {
+    std::sort(m_entries.begin(), m_entries.end(), [](const Pending& a, const Pending& b) {
+        return entryLess(a.entry, b.entry);
+    });
+    for (size_t i = 1; i < m_entries.size(); ++i) {
+        if (!entryLess(m_entries[i - 1].entry, m_entries[i].entry)) return false; // duplicate id
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+
+    static const char zeros[8] = {};
+    uint64_t pos = sizeof(Pack::Header);
+    out.seekp(pos);
+
+    std::string names;
+    std::vector<Pack::Entry> index;
+    index.reserve(m_entries.size());
+    for (auto& pending : m_entries) {
+        uint64_t aligned = alignUp(pos, 8);
+        out.write(zeros, aligned - pos);
+        pos = aligned;
+
+        pending.entry.offset = pos;
+        pending.entry.nameOffset = (uint32_t)names.size();
+        names += pending.name;
+        names += '\0';
+
+        out.write(reinterpret_cast<const char*>(pending.data.data()), pending.data.size());
+        pos += pending.data.size();
+        index.push_back(pending.entry);
+    }
+
+    Pack::Header header = {};
+    std::memcpy(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC));
+    header.version = Pack::VERSION;
+    header.entryCount = (uint32_t)index.size();
+    header.namesOffset = pos;
+    out.write(names.data(), names.size());
+    pos += names.size();
+
+    uint64_t aligned = alignUp(pos, alignof(Pack::Entry));
+    out.write(zeros, aligned - pos);
+    header.indexOffset = aligned;
+    out.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(Pack::Entry));
+
+    // header last, a half written pack never looks valid
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    return (bool)out;
+}
+
+} // namespace Common
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <common/mappedFile.hpp>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Common {
+
+// Single-file asset archive (assets.pack), built by tools/packer.cpp.
+//
+// Layout: header, entry data (8 byte aligned, stored or deflated), a name
+// table, then the index sorted by (type, id). Images use their numeric
+// file stem as id, audio gets ids in name order. The reader mmaps the pack
+// and binary searches the index in place; stored entries are handed out
+// as pointers into the mapping.
+class Pack {
+public:
+    enum class Type : uint32_t {
+        Image = 0,
+        Audio = 1,
+    };
+
+    enum class Method : uint32_t {
+        Stored = 0,
+        Deflated = 1,
+    };
+
+    struct Entry {
+        Type type;
+        int32_t id;
+        Method method;
+        uint32_t nameOffset;    // into the name table, NUL terminated
+        int64_t sourceTime;     // last write time of the loose file it was packed from
+        uint64_t offset;
+        uint64_t storedSize;
+        uint64_t size;
+    };
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t entryCount;
+        uint64_t namesOffset;
+        uint64_t indexOffset;
+    };
+
+    static constexpr uint32_t VERSION = 1;
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return m_index != nullptr; }
+
+    const Entry* find(Type type, int id) const;
+    // every entry of one type, in id order
+    const Entry* begin(Type type) const;
+    const Entry* end(Type type) const;
+
+    std::string_view name(const Entry& entry) const;
+
+    // Stored entries point straight into the mapping and leave scratch alone,
+    // deflated ones are inflated into scratch. Safe to call from any thread.
+    bool read(const Entry& entry, const unsigned char*& data, size_t& size, std::vector<unsigned char>& scratch) const;
+
+private:
+    MappedFile m_file;
+    const Entry* m_index = nullptr;
+    uint32_t m_count = 0;
+    const char* m_names = nullptr;
+    uint64_t m_namesSize = 0;
+};
+
+// Builds a pack in memory and writes it out in one go
+class PackWriter {
+public:
+    // deflates the data and keeps it that way only if it actually gets smaller
+    void add(Pack::Type type, int id, const std::string& name, int64_t sourceTime,
+        const std::vector<unsigned char>& data, bool tryDeflate);
+
+    bool write(const std::string& path);
+
+    size_t getRawBytes() const { return m_rawBytes; }
+    size_t getStoredBytes() const { return m_storedBytes; }
+
+private:
+    struct Pending {
+        Pack::Entry entry;
+        std::string name;
+        std::vector<unsigned char> data;
+    };
+
+    std::vector<Pending> m_entries;
+    size_t m_rawBytes = 0;
+    size_t m_storedBytes = 0;
+};
+
+} // namespace Common
@@ -0,0 +1,50 @@
+#include "debug.hpp"
+#include <imgui.h>
+#include <vector>
+#include <algorithm>
+
+namespace Core {
+namespace Debug {
+
+struct Panel {
+    std::string name;
+    std::function<void()> draw;
+};
+
+static std::vector<Panel> panels;
+static bool visible = false;
+
+void addPanel(const std::string& name, std::function<void()> draw) {
+    removePanel(name);
+    panels.push_back({ name, std::move(draw) });
+}
+
+void removePanel(const std::string& name) {
+    panels.erase(std::remove_if(panels.begin(), panels.end(),
+        [&](const Panel& p) { return p.name == name; }), panels.end());
+}
+
+void toggle() {
+    visible = !visible;
+}
+
+bool isVisible() {
+    return visible;
+}
+
+void render() {
+    if (!visible) return;
+
+    ImGui::SetNextWindowPos(ImVec2(10, 80), ImGuiCond_FirstUseEver);
+    if (ImGui::Begin("Debug (F3)", &visible, ImGuiWindowFlags_AlwaysAutoResize)) {
+        for (auto& panel : panels) {
+            if (ImGui::CollapsingHeader(panel.name.c_str(), ImGuiTreeNodeFlags_DefaultOpen)) {
+                panel.draw();
+            }
+        }
+    }
+    ImGui::End();
+}
+
+} // namespace Debug
+} // namespace Core
@@ -0,0 +1,19 @@
+#pragma once
+#include <functional>
+#include <string>
+
+namespace Core {
+namespace Debug {
+
+// ImGui overlay (toggled with F3). Systems register a panel that draws
+// their stats with plain ImGui calls; panels show up as collapsing headers.
+void addPanel(const std::string& name, std::function<void()> draw);
+void removePanel(const std::string& name);
+
+void toggle();
+bool isVisible();
+
+void render();
+
+} // namespace Debug
+} // namespace Core
@@ -1,6 +1,7 @@
 #include "game.hpp"
 
 #include <iostream>
+#include <chrono>
 #include <filesystem>
 #include <string>
 
@@ -8,13 +9,19 @@
 #include <backends/imgui_impl_sdl3.h>
 #include <backends/imgui_impl_opengl3.h>
 
+#include <common/log.hpp>
+
 #include <core/viewport.hpp>
 #include <core/timer.hpp>
 #include <core/input.hpp>
+#include <core/debug.hpp>
 
 #include <core/rendering/gl2d.hpp>
+#include <core/rendering/glState.hpp>
 #include <core/rendering/image.hpp>
 #include <core/rendering/text.hpp>
+#include <core/rendering/renderQueue.hpp>
+#include <core/rendering/gpuProfiler.hpp>
 
 // for printf
 #include <stdio.h>
@@ -24,6 +31,13 @@ namespace Core {
 Game::Game() : m_window(nullptr), m_glContext(nullptr), m_isRunning(false) {}
 
 int Game::init(const char* title, int width, int height, int _windowWidth, int _windowHeight) {
+#ifdef OS_LINUX
+    // build machines have no display server; SDL's offscreen driver gets a
+    // surfaceless EGL context instead
+    if (m_headless && !SDL_getenv("DISPLAY") && !SDL_getenv("WAYLAND_DISPLAY")) {
+        SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+    }
+#endif
     if (!SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS)) {
         std::cerr << "SDL_Init Error: " << SDL_GetError() << std::endl;
         return -1;
@@ -43,8 +57,9 @@ int Game::init(const char* title, int width, int height, int _windowWidth, int _
     SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
 	SDL_GL_SetAttribute(SDL_GL_STENCIL_SIZE, 8);
     
-    SDL_GL_SetAttribute(SDL_GL_MULTISAMPLEBUFFERS, 1);
-    SDL_GL_SetAttribute(SDL_GL_MULTISAMPLESAMPLES, 4);
+    // headless draws into its own single-sampled FBO, the default one is never shown
+    SDL_GL_SetAttribute(SDL_GL_MULTISAMPLEBUFFERS, m_headless ? 0 : 1);
+    SDL_GL_SetAttribute(SDL_GL_MULTISAMPLESAMPLES, m_headless ? 0 : 4);
 
 	SDL_GL_SetAttribute(SDL_GL_FRAMEBUFFER_SRGB_CAPABLE, 1);
 
@@ -52,14 +67,16 @@ int Game::init(const char* title, int width, int height, int _windowWidth, int _
         SDL_GL_SetAttribute(SDL_GL_ACCELERATED_VISUAL, 1);
     #endif
 
-    m_window = SDL_CreateWindow(title, 1024, 768, SDL_WINDOW_OPENGL);
+    m_window = SDL_CreateWindow(title, 1024, 768, SDL_WINDOW_OPENGL | (m_headless ? SDL_WINDOW_HIDDEN : 0));
     if (!m_window) {
         fprintf(stderr, "SDL_CreateWindow failed: %s\n", SDL_GetError());
         return -1;
     }
 
-    SDL_SetWindowPosition(m_window, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED);
-    SDL_SetWindowResizable(m_window, true);
+    if (!m_headless) {
+        SDL_SetWindowPosition(m_window, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED);
+        SDL_SetWindowResizable(m_window, true);
+    }
 
     m_glContext = SDL_GL_CreateContext(m_window);
     if (!m_glContext) {
@@ -78,7 +95,14 @@ int Game::init(const char* title, int width, int height, int _windowWidth, int _
 
     glEnable(GL_MULTISAMPLE);
 
+    if (m_headless) {
+        printf("Headless (%s video driver)\n", SDL_GetCurrentVideoDriver());
+        if (!createOffscreenTarget(width, height)) return -1;
+    }
+
     Core::Rendering::GL2D::init();
+    Core::Rendering::RenderQueue::init();
+    Core::Rendering::GPUProfiler::init();
 
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
@@ -106,6 +130,24 @@ int Game::init(const char* title, int width, int height, int _windowWidth, int _
     return 0;
 }
 
+bool Game::createOffscreenTarget(int width, int height) {
+    glGenRenderbuffers(1, &m_fboColor);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_fboColor);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenFramebuffers(1, &m_fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_fboColor);
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        fprintf(stderr, "Offscreen framebuffer incomplete: 0x%x\n", status);
+        return false;
+    }
+    // stays bound, nothing else renders to the default framebuffer in headless mode
+    return true;
+}
+
 void Game::handleEvents() {
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
@@ -115,6 +157,8 @@ void Game::handleEvents() {
             m_isRunning = false;
         } else if (event.type == SDL_EVENT_WINDOW_RESIZED) {
             onResize(event.window.data1, event.window.data2);
+        } else if (event.type == SDL_EVENT_KEY_DOWN && !event.key.repeat && event.key.scancode == SDL_SCANCODE_F3) {
+            Core::Debug::toggle();
         }
 
         if (m_state) m_state->handleEvents(*this, event);
@@ -130,7 +174,8 @@ void Game::update() {
 
 void Game::onResize(int w, int h) {
     Viewport vp = calculateViewport(w, h, gameWidth, gameHeight);
-    glViewport(vp.x, vp.y, vp.w, vp.h);
+    Core::Rendering::GL2D::flush();
+    Core::Rendering::GLState::viewport(vp.x, vp.y, vp.w, vp.h);
 
     if (m_state) m_state->onResize(*this, w, h);
     
@@ -141,29 +186,44 @@ void Game::onResize(int w, int h) {
 
 void Game::render() {
     int winW, winH;
-    SDL_GetWindowSize(m_window, &winW, &winH);
+    if (m_headless) {
+        // the FBO is exactly the game size, so no letterboxing
+        winW = gameWidth;
+        winH = gameHeight;
+        glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    } else {
+        SDL_GetWindowSize(m_window, &winW, &winH);
+    }
     glClear(GL_COLOR_BUFFER_BIT);
 
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplSDL3_NewFrame();
     ImGui::NewFrame();
 
+    namespace GPUProfiler = Core::Rendering::GPUProfiler;
+    GPUProfiler::beginFrame();
+    GPUProfiler::begin("Frame");
+
     Viewport vp = calculateViewport(winW, winH, gameWidth, gameHeight);
+    // the viewport does the scaling, GL2D always works in game pixels
+    Core::Rendering::GL2D::setProjection((float)gameWidth, (float)gameHeight);
 
     Core::Rendering::TextRenderer::getInstance().setViewport(
         0, 0, winW, winH, winW, winH
     );
 
-    glViewport(0, 0, winW, winH);
+    GPUProfiler::begin("Letterbox");
+    Core::Rendering::GLState::viewport(0, 0, winW, winH);
     {
-        static const Core::Rendering::GL2D::Vertex screenQuad[6] = {
-            {-1.f,  1.f, 0.f,0.f, 0.1f,0.1f,0.1f,1.f},
-            {-1.f, -1.f, 0.f,0.f, 0.1f,0.1f,0.1f,1.f},
-            { 1.f, -1.f, 0.f,0.f, 0.1f,0.1f,0.1f,1.f},
-
-            { 1.f, -1.f, 0.f,0.f, 0.1f,0.1f,0.1f,1.f},
-            { 1.f,  1.f, 0.f,0.f, 0.1f,0.1f,0.1f,1.f},
-            {-1.f,  1.f, 0.f,0.f, 0.1f,0.1f,0.1f,1.f},
+        const float w = (float)gameWidth, h = (float)gameHeight;
+        const Core::Rendering::GL2D::Vertex screenQuad[6] = {
+            {0.f, 0.f, 0.f,0.f, 0.1f,0.1f,0.1f,1.f},
+            {0.f, h,   0.f,0.f, 0.1f,0.1f,0.1f,1.f},
+            {w,   h,   0.f,0.f, 0.1f,0.1f,0.1f,1.f},
+
+            {w,   h,   0.f,0.f, 0.1f,0.1f,0.1f,1.f},
+            {w,   0.f, 0.f,0.f, 0.1f,0.1f,0.1f,1.f},
+            {0.f, 0.f, 0.f,0.f, 0.1f,0.1f,0.1f,1.f},
         };
         Core::Rendering::GL2D::drawTriangles(screenQuad, 6);
     }
@@ -172,47 +232,88 @@ void Game::render() {
         vp.x, vp.y, vp.w, vp.h, winW, winH
     );
 
-    glViewport(vp.x, vp.y, vp.w, vp.h);
+    Core::Rendering::GL2D::flush();
+    Core::Rendering::GLState::viewport(vp.x, vp.y, vp.w, vp.h);
     {
-        static const Core::Rendering::GL2D::Vertex screenQuad[6] = {
-            {-1.f,  1.f, 0.f,0.f, 0.f,0.f,0.f,1.f},
-            {-1.f, -1.f, 0.f,0.f, 0.f,0.f,0.f,1.f},
-            { 1.f, -1.f, 0.f,0.f, 0.f,0.f,0.f,1.f},
-
-            { 1.f, -1.f, 0.f,0.f, 0.f,0.f,0.f,1.f},
-            { 1.f,  1.f, 0.f,0.f, 0.f,0.f,0.f,1.f},
-            {-1.f,  1.f, 0.f,0.f, 0.f,0.f,0.f,1.f},
+        const float w = (float)gameWidth, h = (float)gameHeight;
+        const Core::Rendering::GL2D::Vertex screenQuad[6] = {
+            {0.f, 0.f, 0.f,0.f, 0.f,0.f,0.f,1.f},
+            {0.f, h,   0.f,0.f, 0.f,0.f,0.f,1.f},
+            {w,   h,   0.f,0.f, 0.f,0.f,0.f,1.f},
+
+            {w,   h,   0.f,0.f, 0.f,0.f,0.f,1.f},
+            {w,   0.f, 0.f,0.f, 0.f,0.f,0.f,1.f},
+            {0.f, 0.f, 0.f,0.f, 0.f,0.f,0.f,1.f},
         };
         Core::Rendering::GL2D::drawTriangles(screenQuad, 6);
     }
+    GPUProfiler::end();
 
     if (m_state) {
+        GPUProfiler::Scope scope(m_state->state_name.c_str());
         m_state->render(*this);
+        // whatever the state queued goes out here, under anything drawn after
+        Core::Rendering::RenderQueue::flush();
+    }
+
+    {
+        GPUProfiler::Scope scope("FPS text");
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "FPS: %d", (int)Core::Timer::getFPS());
+        Core::Rendering::print(buf, 10, 20);
     }
 
-    char buf[32];
-    std::snprintf(buf, sizeof(buf), "FPS: %d", (int)Core::Timer::getFPS());
-    Core::Rendering::print(buf, 10, 20);
+    Core::Rendering::GL2D::endFrame();
+    Core::Rendering::GLState::viewport(0, 0, winW, winH);
 
-    glViewport(0, 0, winW, winH);
+    Core::Debug::render();
 
     ImGui::Render();
+    GPUProfiler::begin("ImGui");
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-
-    SDL_GL_SwapWindow(m_window);
+    GPUProfiler::end();
+    // ImGui restores what it found, but not through the shadow
+    Core::Rendering::GLState::invalidate();
+
+    GPUProfiler::end();
+    GPUProfiler::endFrame();
+
+    if (m_headless) {
+        // no swap to pace frames; wait for the GPU so frame times include its work
+        glFinish();
+    } else {
+        SDL_GL_SwapWindow(m_window);
+    }
 }
 
 bool Game::isRunning() const {
     return m_isRunning;
 }
 
+void Game::prefetchState(std::unique_ptr<State> nextState) {
+    m_nextState = std::move(nextState);
+    if (m_nextState) m_nextState->prefetch(*this);
+}
+
 void Game::changeState(std::unique_ptr<State> newState) {
+    // a prefetched state we're not switching to is stale now
+    if (m_nextState && m_nextState.get() != newState.get()) m_nextState.reset();
+
+    auto start = std::chrono::high_resolution_clock::now();
+
     // KILL the old state
     if (m_state) m_state->leave(*this);
 
     m_state = std::move(newState);
     if (m_state) m_state->enter(*this);
 
+    // whatever enter() had to load synchronously shows up here as a hitch
+    double blockedMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    char buf[128];
+    std::snprintf(buf, sizeof(buf), "State transition to '%s' blocked for %.2f ms",
+        m_state ? m_state->state_name.c_str() : "none", blockedMs);
+    Common::info(buf);
+
     // flush some events
     SDL_FlushEvent(SDL_EVENT_KEY_DOWN);
     SDL_FlushEvent(SDL_EVENT_KEY_UP);
@@ -225,6 +326,7 @@ void Game::changeState(std::unique_ptr<State> newState) {
 }
 
 void Game::cleanup() {
+    m_nextState.reset();
     if (m_state) {
         m_state->leave(*this);
         m_state.reset();
@@ -232,6 +334,8 @@ void Game::cleanup() {
 }
 
 Game::~Game() {
+    if (m_fbo) glDeleteFramebuffers(1, &m_fbo);
+    if (m_fboColor) glDeleteRenderbuffers(1, &m_fboColor);
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplSDL3_Shutdown();
     ImGui::DestroyContext();
@@ -31,9 +31,31 @@ public:
     template<typename T, typename... Args>
     void changeState(Args&&... args) {
         static_assert(std::is_base_of<State, T>::value, "T must derive from State");
+        // reuse the prefetched instance so its in-flight loads aren't wasted
+        if constexpr (sizeof...(Args) == 0) {
+            if (m_nextState && dynamic_cast<T*>(m_nextState.get())) {
+                changeState(std::move(m_nextState));
+                return;
+            }
+        }
         changeState(std::make_unique<T>(std::forward<Args>(args)...));
     }
 
+    // Constructs the next state early and lets it start loading in the background.
+    // A later changeState<T>() with no arguments picks it up.
+    void prefetchState(std::unique_ptr<State> nextState);
+    template<typename T, typename... Args>
+    void prefetchState(Args&&... args) {
+        static_assert(std::is_base_of<State, T>::value, "T must derive from State");
+        prefetchState(std::make_unique<T>(std::forward<Args>(args)...));
+    }
+
+    // Before init(): hidden window (SDL's EGL "offscreen" driver when there's
+    // no display), no MSAA, and every frame goes into a gameWidth x gameHeight
+    // FBO instead of a swapchain.
+    void setHeadless(bool headless) { m_headless = headless; }
+    bool isHeadless() const { return m_headless; }
+
     SDL_Window* getWindow() const { return m_window; }
     std::string getLastError() const { return m_lastError; }
     void setLastError(const std::string& error) { m_lastError = error; }
@@ -48,6 +70,11 @@ public:
 
 private:
     bool m_isRunning;
+    bool m_headless = false;
+    GLuint m_fbo = 0;
+    GLuint m_fboColor = 0;
+
+    bool createOffscreenTarget(int width, int height);
 
     SDL_Window* m_window;
     SDL_GLContext m_glContext;
@@ -55,6 +82,7 @@ private:
     std::string m_lastError;
 
     std::unique_ptr<State> m_state;
+    std::unique_ptr<State> m_nextState;
 };
 
 } // namespace Core
\ No newline at end of file
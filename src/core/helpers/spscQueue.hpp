@@ -0,0 +1,45 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+namespace Core {
+namespace Helpers {
+
+// Fixed size lock-free ring for exactly one producer and one consumer thread
+// (e.g. the mixer thread posting to the main thread). Never allocates or
+// blocks; tryPush fails when full, tryPop when empty.
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+    bool tryPush(const T& value) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) == Capacity) return false;
+        m_items[head & (Capacity - 1)] = value;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T& value) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire)) return false;
+        value = m_items[tail & (Capacity - 1)];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // approximate when called from outside the two threads
+    size_t size() const {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+
+private:
+    T m_items[Capacity];
+    // kept apart so producer and consumer don't share a cache line
+    alignas(64) std::atomic<size_t> m_head{ 0 };
+    alignas(64) std::atomic<size_t> m_tail{ 0 };
+};
+
+} // namespace Helpers
+} // namespace Core
@@ -0,0 +1,71 @@
+#include "workerPool.hpp"
+
+namespace Core {
+namespace Helpers {
+
+WorkerPool& WorkerPool::get() {
+    static WorkerPool instance;
+    return instance;
+}
+
+WorkerPool::WorkerPool() {
+    // leave one core for the main thread, it does all the GL uploads
+    unsigned int count = std::thread::hardware_concurrency();
+    count = (count > 1) ? count - 1 : 1;
+
+    m_threads.reserve(count);
+    for (unsigned int i = 0; i < count; ++i) {
+        m_threads.emplace_back(&WorkerPool::workerLoop, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_jobReady.notify_all();
+
+    for (auto& t : m_threads) {
+        if (t.joinable()) t.join();
+    }
+}
+
+void WorkerPool::submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back(std::move(job));
+    }
+    m_jobReady.notify_one();
+}
+
+void WorkerPool::waitIdle() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] { return m_jobs.empty() && m_busy == 0; });
+}
+
+void WorkerPool::workerLoop() {
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_jobReady.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+            if (m_stopping && m_jobs.empty()) return;
+
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+            ++m_busy;
+        }
+
+        job();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_busy;
+            if (m_jobs.empty() && m_busy == 0) m_idle.notify_all();
+        }
+    }
+}
+
+} // namespace Helpers
+} // namespace Core
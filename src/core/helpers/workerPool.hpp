@@ -0,0 +1,42 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Core {
+namespace Helpers {
+
+// Persistent pool of worker threads for CPU-side work (image decoding, file reads).
+// Jobs must not touch GL; hand results back to the main thread instead.
+class WorkerPool {
+public:
+    static WorkerPool& get();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    void submit(std::function<void()> job);
+    void waitIdle();
+
+    size_t size() const { return m_threads.size(); }
+
+private:
+    WorkerPool();
+    ~WorkerPool();
+
+    void workerLoop();
+
+    std::vector<std::thread> m_threads;
+    std::deque<std::function<void()>> m_jobs;
+    std::mutex m_mutex;
+    std::condition_variable m_jobReady;
+    std::condition_variable m_idle;
+    size_t m_busy = 0;
+    bool m_stopping = false;
+};
+
+} // namespace Helpers
+} // namespace Core
@@ -2,3 +2,4 @@
 #include <core/rendering/image.hpp>
 #include <core/rendering/text.hpp>
 #include <core/rendering/shapes.hpp>
+#include <core/rendering/renderQueue.hpp>
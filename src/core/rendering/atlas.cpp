@@ -0,0 +1,127 @@
+#include "atlas.hpp"
+#include <common/log.hpp>
+#include <algorithm>
+#include <cstring>
+
+namespace Core {
+namespace Rendering {
+
+AtlasBuilder::AtlasBuilder(int pageSize, int padding)
+    : m_pageSize(pageSize), m_padding(padding) {
+}
+
+bool AtlasBuilder::fits(int width, int height) const {
+    return width > 0 && height > 0 &&
+           width + m_padding * 2 <= m_pageSize &&
+           height + m_padding * 2 <= m_pageSize;
+}
+
+void AtlasBuilder::add(Image* image, PixelData&& data) {
+    TrimRect trim = data.trim.width > 0 ? data.trim : TrimRect{ 0, 0, data.width, data.height };
+    if (!image || !fits(trim.width, trim.height)) return;
+    int width = data.width;
+    int height = data.height;
+    m_pending.push_back({ image, std::move(data), nullptr, width, height, trim });
+}
+
+void AtlasBuilder::add(Image* image, const unsigned char* pixels, int width, int height, const TrimRect& trim) {
+    TrimRect rect = trim.width > 0 ? trim : TrimRect{ 0, 0, width, height };
+    if (!image || !pixels || !fits(rect.width, rect.height)) return;
+    m_pending.push_back({ image, PixelData{}, pixels, width, height, rect });
+}
+
+bool AtlasBuilder::place(Page& page, int width, int height, int& outX, int& outY) {
+    // simple shelf packer, fed tallest first so shelves stay tight
+    if (page.cursorX + width > m_pageSize) {
+        page.cursorX = 0;
+        page.cursorY += page.shelfHeight;
+        page.shelfHeight = 0;
+    }
+    if (page.cursorY + height > m_pageSize) return false;
+
+    outX = page.cursorX;
+    outY = page.cursorY;
+    page.cursorX += width;
+    page.shelfHeight = std::max(page.shelfHeight, height);
+    return true;
+}
+
+void AtlasBuilder::blit(Page& page, const Pending& item, int x, int y) {
+    // copy the image and extrude its edge pixels into the padding so
+    // linear filtering at the border never picks up a neighbour
+    const int pad = m_padding;
+    const size_t pageStride = (size_t)m_pageSize * 4;
+    const size_t srcStride = (size_t)item.sourceWidth * 4;
+    const size_t rowBytes = (size_t)item.trim.width * 4;
+    const unsigned char* pixels = item.pixels();
+
+    for (int row = -pad; row < item.trim.height + pad; ++row) {
+        int srcRow = std::clamp(row, 0, item.trim.height - 1);
+        unsigned char* dst = page.pixels.data() + (size_t)(y + pad + row) * pageStride + (size_t)x * 4;
+        const unsigned char* src = pixels + (size_t)srcRow * srcStride;
+
+        for (int i = 0; i < pad; ++i) {
+            std::memcpy(dst + (size_t)i * 4, src, 4);
+            std::memcpy(dst + (size_t)(pad + item.trim.width + i) * 4, src + rowBytes - 4, 4);
+        }
+        std::memcpy(dst + (size_t)pad * 4, src, rowBytes);
+    }
+}
+
+void AtlasBuilder::finish() {
+    std::stable_sort(m_pending.begin(), m_pending.end(), [](const Pending& a, const Pending& b) {
+        return a.trim.height > b.trim.height;
+    });
+
+    struct Placement {
+        Image* image;
+        size_t page;
+        int x, y, w, h;
+        int sourceWidth, sourceHeight;
+        TrimRect trim;
+    };
+    std::vector<Placement> placements;
+    placements.reserve(m_pending.size());
+
+    for (auto& item : m_pending) {
+        int w = item.trim.width + m_padding * 2;
+        int h = item.trim.height + m_padding * 2;
+        int x = 0, y = 0;
+
+        if (m_pages.empty() || m_pages.back().texture || !place(m_pages.back(), w, h, x, y)) {
+            m_pages.emplace_back();
+            m_pages.back().pixels.assign((size_t)m_pageSize * m_pageSize * 4, 0);
+            place(m_pages.back(), w, h, x, y);
+        }
+
+        blit(m_pages.back(), item, x, y);
+        placements.push_back({ item.image, m_pages.size() - 1,
+                               x + m_padding, y + m_padding,
+                               item.trim.width, item.trim.height,
+                               item.sourceWidth, item.sourceHeight, item.trim });
+    }
+    m_pending.clear();
+
+    for (auto& page : m_pages) {
+        if (page.texture) continue;
+        page.texture = Texture::create(page.pixels.data(), m_pageSize, m_pageSize);
+        if (!page.texture) Common::error("Unable to create atlas page texture");
+        page.pixels.clear();
+        page.pixels.shrink_to_fit();
+    }
+
+    const float inv = 1.0f / (float)m_pageSize;
+    for (const auto& p : placements) {
+        const auto& texture = m_pages[p.page].texture;
+        if (!texture) continue;
+        p.image->setTexture(texture,
+            p.x * inv, p.y * inv,
+            (p.x + p.w) * inv, (p.y + p.h) * inv);
+        p.image->setDimensions(p.sourceWidth, p.sourceHeight);
+        p.image->setTrim(p.sourceWidth, p.sourceHeight, p.trim);
+        ++m_imageCount;
+    }
+}
+
+} // namespace Rendering
+} // namespace Core
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <core/rendering/image.hpp>
+#include <core/rendering/texture.hpp>
+#include <memory>
+#include <vector>
+
+namespace Core {
+namespace Rendering {
+
+// Packs many small images into a few large textures ("pages").
+// Images are queued with add() and only get their texture + UV range
+// once finish() packs and uploads everything (finish() needs GL).
+// Only the trim rectangle of each image takes up atlas space.
+class AtlasBuilder {
+public:
+    explicit AtlasBuilder(int pageSize = 2048, int padding = 1);
+
+    bool fits(int width, int height) const;
+    void add(Image* image, PixelData&& data);
+    // borrowed pixels (e.g. a cache mapping), must stay valid until finish()
+    void add(Image* image, const unsigned char* pixels, int width, int height, const TrimRect& trim = {});
+    void finish();
+
+    size_t getPageCount() const { return m_pages.size(); }
+    size_t getImageCount() const { return m_imageCount; }
+    int getPageSize() const { return m_pageSize; }
+
+private:
+    struct Pending {
+        Image* image;
+        PixelData data;
+        const unsigned char* borrowed;
+        int sourceWidth;
+        int sourceHeight;
+        TrimRect trim;
+
+        // top left of the trimmed area, rows are sourceWidth pixels apart
+        const unsigned char* pixels() const {
+            const unsigned char* base = borrowed ? borrowed : data.pixels.data();
+            return base + ((size_t)trim.y * sourceWidth + trim.x) * 4;
+        }
+    };
+
+    struct Page {
+        std::vector<unsigned char> pixels;
+        std::shared_ptr<Texture> texture;
+        int cursorX = 0;
+        int cursorY = 0;
+        int shelfHeight = 0;
+    };
+
+    bool place(Page& page, int width, int height, int& outX, int& outY);
+    void blit(Page& page, const Pending& item, int x, int y);
+
+    int m_pageSize;
+    int m_padding;
+    size_t m_imageCount = 0;
+    std::vector<Pending> m_pending;
+    std::vector<Page> m_pages;
+};
+
+} // namespace Rendering
+} // namespace Core
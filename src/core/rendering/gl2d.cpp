@@ -1,19 +1,71 @@
 #include "gl2d.hpp"
+#include "glState.hpp"
+#include "streamBuffer.hpp"
+#include <common/common.hpp>
+#include <common/log.hpp>
+#include <core/debug.hpp>
+#include <chrono>
+#include <cmath>
 #include <cstdio>
+#include <cstring>
+
+#include <imgui.h>
 
 namespace Core {
 namespace Rendering {
 namespace GL2D {
 
 static GLuint s_program = 0;
-static GLint s_programSDF = -1;
+static GLuint s_programSDF = 0;
+static GLuint s_programSprite = 0;
 
 static GLuint s_vao = 0;
-static GLuint s_vbo = 0;
+static GLuint s_quadIndices = 0;
+static GLuint s_spriteVao = 0;
+static StreamBuffer s_stream;
 
 static GLint s_locUseTex = -1;
 static GLint s_locTex = -1;
 
+struct BatchKey {
+    GLenum mode;
+    GLuint texture;
+    bool sdf;
+    Blend blend;
+
+    bool operator!=(const BatchKey& other) const {
+        return mode != other.mode || texture != other.texture || sdf != other.sdf || blend != other.blend;
+    }
+};
+
+// enough for ~16k quads before a forced flush, and still addressable with 16-bit indices
+static constexpr size_t MAX_BATCH_VERTICES = 65536;
+static constexpr size_t MAX_BATCH_QUADS = MAX_BATCH_VERTICES / 4;
+
+// batch mode for drawQuads(), not a real GL primitive
+static constexpr GLenum MODE_QUADS = 0xFFFF;
+// batch mode for drawSprites(), instances in s_sprites instead of vertices
+static constexpr GLenum MODE_SPRITES = 0xFFFE;
+static constexpr size_t MAX_BATCH_SPRITES = 16384;
+// each of the three segments holds a full batch twice over
+static constexpr size_t STREAM_BUFFER_SIZE = StreamBuffer::SEGMENTS * 2 * MAX_BATCH_VERTICES * sizeof(PackedVertex);
+
+static std::vector<PackedVertex> s_batch;
+static std::vector<Sprite> s_sprites;
+static BatchKey s_key{ GL_TRIANGLES, 0, false, {} };
+static bool s_batching = true;
+static bool s_instancing = true;
+static bool s_premultipliedTarget = false;
+static int s_lastUseTex = -1;
+static float s_projW = 0.f, s_projH = 0.f;
+
+static Blend s_lastBlend;
+
+static FrameStats s_frame;
+static FrameStats s_lastFrame;
+
+static void drawDebugPanel();
+
 static GLuint compile(GLenum type, const char* src) {
     GLuint sh = glCreateShader(type);
     glShaderSource(sh, 1, &src, nullptr);
@@ -41,6 +93,26 @@ static GLuint link(GLuint vs, GLuint fs) {
     return prog;
 }
 
+// attribute layouts for the bound VAO / GL_ARRAY_BUFFER; the shader sees
+// the same vec2/vec2/vec4 either way, packed UV and colour are normalised
+static void setPackedAttribs() {
+    glEnableVertexAttribArray(0); // aPos
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, x));
+    glEnableVertexAttribArray(1); // aUV
+    glVertexAttribPointer(1, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, u));
+    glEnableVertexAttribArray(2); // aColor
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, r));
+}
+
+static void setFloatAttribs() {
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, x));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, u));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, r));
+}
+
 bool init() {
     if (s_program) return true;
 
@@ -50,13 +122,15 @@ bool init() {
         layout(location=1) in vec2 aUV;
         layout(location=2) in vec4 aColor;
 
+        uniform mat4 uProjection;
+
         out vec2 vUV;
         out vec4 vColor;
 
         void main() {
             vUV = aUV;
             vColor = aColor;
-            gl_Position = vec4(aPos, 0.0, 1.0);
+            gl_Position = uProjection * vec4(aPos, 0.0, 1.0);
         }
     )GLSL";
 
@@ -100,110 +174,475 @@ bool init() {
         }
     )GLSL";
 
+    // corner from gl_VertexID, drawn as a 4 vertex strip per instance
+    const char* vsSprite = R"GLSL(
+        #version 330 core
+        layout(location=0) in vec2 aPivot;
+        layout(location=1) in vec4 aRect;
+        layout(location=2) in float aRotation;
+        layout(location=3) in vec4 aUV;
+        layout(location=4) in vec4 aColor;
+
+        uniform mat4 uProjection;
+
+        out vec2 vUV;
+        out vec4 vColor;
+
+        void main() {
+            vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+            vec2 local = aRect.xy + corner * aRect.zw;
+            float c = cos(aRotation), s = sin(aRotation);
+            vec2 p = aPivot + vec2(local.x * c - local.y * s, local.x * s + local.y * c);
+            gl_Position = uProjection * vec4(p, 0.0, 1.0);
+            vUV = mix(aUV.xy, aUV.zw, corner);
+            vColor = aColor;
+        }
+    )GLSL";
+
     GLuint vs = compile(GL_VERTEX_SHADER, vsSrc);
     if (!vs) return false;
     GLuint fs = compile(GL_FRAGMENT_SHADER, fsSrc);
     if (!fs) { glDeleteShader(vs); return false; }
 
     s_program = link(vs, fs);
-    glDeleteShader(vs);
-    glDeleteShader(fs);
 
     GLuint fs_sdf = compile(GL_FRAGMENT_SHADER, fsSDF);
     s_programSDF = link(vs, fs_sdf);
     glDeleteShader(fs_sdf);
+    glDeleteShader(vs);
+
+    GLuint vs_sprite = compile(GL_VERTEX_SHADER, vsSprite);
+    if (vs_sprite) {
+        s_programSprite = link(vs_sprite, fs);
+        glDeleteShader(vs_sprite);
+    }
+    glDeleteShader(fs);
 
     if (!s_program) return false;
 
-    s_locUseTex = glGetUniformLocation(s_program, "uUseTex");
-    s_locTex = glGetUniformLocation(s_program, "uTex");
+    s_locUseTex = GLState::uniformLocation(s_program, "uUseTex");
+    s_locTex = GLState::uniformLocation(s_program, "uTex");
 
-    GLint sdfTex = glGetUniformLocation(s_programSDF, "uTex");
-    GLint sdfWidth = glGetUniformLocation(s_programSDF, "uSDFWidth");
+    GLint sdfTex = GLState::uniformLocation(s_programSDF, "uTex");
+    GLint sdfWidth = GLState::uniformLocation(s_programSDF, "uSDFWidth");
 
-    glUseProgram(s_programSDF);
+    GLState::useProgram(s_programSDF);
     if (sdfTex >= 0) glUniform1i(sdfTex, 0);
     if (sdfWidth >= 0) glUniform1f(sdfWidth, 0.015f);
-    glUseProgram(0);
+    GLState::useProgram(s_program);
+    if (s_locTex >= 0) glUniform1i(s_locTex, 0);
 
     glGenVertexArrays(1, &s_vao);
-    glBindVertexArray(s_vao);
-    glGenBuffers(1, &s_vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, s_vbo);
-    glBufferData(GL_ARRAY_BUFFER, 4096, nullptr, GL_DYNAMIC_DRAW);
+    GLState::bindVertexArray(s_vao);
+    s_stream.init(GL_ARRAY_BUFFER, STREAM_BUFFER_SIZE);
+
+    setPackedAttribs();
+
+    // two triangles per quad (0,1,2 2,3,0), prebuilt for the biggest batch;
+    // the element binding is part of the VAO
+    std::vector<GLushort> indices(MAX_BATCH_QUADS * 6);
+    for (size_t q = 0; q < MAX_BATCH_QUADS; ++q) {
+        GLushort base = (GLushort)(q * 4);
+        GLushort quad[6] = { base, (GLushort)(base + 1), (GLushort)(base + 2), (GLushort)(base + 2), (GLushort)(base + 3), base };
+        std::memcpy(&indices[q * 6], quad, sizeof(quad));
+    }
+    glGenBuffers(1, &s_quadIndices);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, s_quadIndices);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)(indices.size() * sizeof(GLushort)), indices.data(), GL_STATIC_DRAW);
+
+    // instance attributes point into the ring, so their offsets are set per flush
+    if (s_programSprite) {
+        GLState::useProgram(s_programSprite);
+        GLint spriteUseTex = GLState::uniformLocation(s_programSprite, "uUseTex");
+        GLint spriteTex = GLState::uniformLocation(s_programSprite, "uTex");
+        if (spriteUseTex >= 0) glUniform1i(spriteUseTex, 1);
+        if (spriteTex >= 0) glUniform1i(spriteTex, 0);
+
+        glGenVertexArrays(1, &s_spriteVao);
+        GLState::bindVertexArray(s_spriteVao);
+        for (GLuint i = 0; i < 5; ++i) {
+            glEnableVertexAttribArray(i);
+            glVertexAttribDivisor(i, 1);
+        }
+    } else {
+        Common::warn("GL2D: sprite shader unavailable, sprites will be expanded on the CPU");
+    }
 
-    glEnableVertexAttribArray(0); // aPos
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, x));
-    glEnableVertexAttribArray(1); // aUV
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, u));
-    glEnableVertexAttribArray(2); // aColor
-    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, r));
+    GLState::bindVertexArray(0);
 
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    s_batch.reserve(MAX_BATCH_VERTICES);
+    s_sprites.reserve(MAX_BATCH_SPRITES);
+    Core::Debug::addPanel("Renderer", drawDebugPanel);
 
     return true;
 }
 
 
 void shutdown() {
-    if (s_vbo) { glDeleteBuffers(1, &s_vbo); s_vbo = 0; }
-    if (s_vao) { glDeleteVertexArrays(1, &s_vao); s_vao = 0; }
-    if (s_program) { glDeleteProgram(s_program); s_program = 0; }
+    s_batch.clear();
+    s_sprites.clear();
+    s_projW = s_projH = 0.f;
+    Core::Debug::removePanel("Renderer");
+    s_stream.shutdown();
+    if (s_quadIndices) { glDeleteBuffers(1, &s_quadIndices); s_quadIndices = 0; }
+    if (s_spriteVao) { GLState::forgetVertexArray(s_spriteVao); glDeleteVertexArrays(1, &s_spriteVao); s_spriteVao = 0; }
+    if (s_programSprite) { GLState::forgetProgram(s_programSprite); glDeleteProgram(s_programSprite); s_programSprite = 0; }
+    if (s_vao) { GLState::forgetVertexArray(s_vao); glDeleteVertexArrays(1, &s_vao); s_vao = 0; }
+    if (s_program) { GLState::forgetProgram(s_program); glDeleteProgram(s_program); s_program = 0; }
+    if (s_programSDF) { GLState::forgetProgram(s_programSDF); glDeleteProgram(s_programSDF); s_programSDF = 0; }
 }
 
-void draw(GLenum mode, const Vertex* verts, size_t count, GLuint texture, bool sdf) {
-    if (!s_program || !s_vao || !s_vbo || !verts || count == 0) return;
+// Lists in these modes can simply be appended to each other, as long as they
+// hold whole primitives. A stray vertex or two would shift every primitive
+// after it, so such a list is drawn on its own and GL drops the leftovers.
+static bool isMergeable(GLenum mode, size_t count) {
+    switch (mode) {
+    case MODE_QUADS: return count % 4 == 0;
+    case GL_TRIANGLES: return count % 3 == 0;
+    case GL_LINES: return count % 2 == 0;
+    case GL_POINTS: return true;
+    default: return false;
+    }
+}
 
-    GLuint prog = sdf && s_programSDF ? s_programSDF : s_program;
-    glUseProgram(prog);
-    glBindVertexArray(s_vao);
+static void applyBlend() {
+    if (s_key.blend != s_lastBlend) ++s_frame.blendChanges;
+    s_lastBlend = s_key.blend;
+    GLState::setBlendEnabled(true);
+    if (s_premultipliedTarget) {
+        GLState::setBlendFuncSeparate(s_key.blend.src, s_key.blend.dst, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    } else {
+        GLState::setBlendFunc(s_key.blend.src, s_key.blend.dst);
+    }
+}
+
+static bool batchEmpty() {
+    return s_batch.empty() && s_sprites.empty();
+}
+
+static void setSpriteAttribs(GLintptr base) {
+    const GLsizei stride = sizeof(Sprite);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, (void*)(base + offsetof(Sprite, x)));
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, (void*)(base + offsetof(Sprite, offsetX)));
+    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, stride, (void*)(base + offsetof(Sprite, rotation)));
+    glVertexAttribPointer(3, 4, GL_UNSIGNED_SHORT, GL_TRUE, stride, (void*)(base + offsetof(Sprite, u0)));
+    glVertexAttribPointer(4, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void*)(base + offsetof(Sprite, r)));
+}
+
+static void flushSprites() {
+    GLState::useProgram(s_programSprite);
+    GLState::bindVertexArray(s_spriteVao);
+    applyBlend();
+
+    GLintptr offset = s_stream.write(s_sprites.data(), s_sprites.size() * sizeof(Sprite), 16);
+    if (offset < 0) {
+        s_sprites.clear();
+        return;
+    }
+    setSpriteAttribs(offset);
 
-    static GLsizeiptr s_vboSize = 0;
-    GLsizeiptr bytes = (GLsizeiptr)(count * sizeof(Vertex));
+    GLState::bindTexture(0, s_key.texture);
 
-    glBindBuffer(GL_ARRAY_BUFFER, s_vbo);
-    if (bytes > s_vboSize) {
-        glBufferData(GL_ARRAY_BUFFER, bytes, verts, GL_DYNAMIC_DRAW);
-        s_vboSize = bytes;
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)s_sprites.size());
+    ++s_frame.batches;
+    s_sprites.clear();
+}
+
+void flush() {
+    if (!s_sprites.empty()) {
+        flushSprites();
+        return;
+    }
+    if (s_batch.empty()) return;
+
+    GLuint prog = s_key.sdf && s_programSDF ? s_programSDF : s_program;
+    GLState::useProgram(prog);
+    GLState::bindVertexArray(s_vao);
+    applyBlend();
+
+    GLintptr offset = s_stream.write(s_batch.data(), s_batch.size() * sizeof(PackedVertex), sizeof(PackedVertex));
+    if (offset < 0) {
+        s_batch.clear();
+        return;
+    }
+
+    bool useTex = s_key.texture != 0;
+    if (prog == s_program && s_locUseTex >= 0 && s_lastUseTex != (int)useTex) {
+        glUniform1i(s_locUseTex, useTex);
+        s_lastUseTex = useTex;
+    }
+    if (useTex) GLState::bindTexture(0, s_key.texture);
+
+    GLint first = (GLint)(offset / sizeof(PackedVertex));
+    if (s_key.mode == MODE_QUADS) {
+        glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)(s_batch.size() / 4 * 6), GL_UNSIGNED_SHORT, nullptr, first);
     } else {
-        void* ptr = glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes,
-                                     GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
-        if (ptr) {
-            std::memcpy(ptr, verts, bytes);
-            glUnmapBuffer(GL_ARRAY_BUFFER);
-        }
+        glDrawArrays(s_key.mode, first, (GLsizei)s_batch.size());
     }
+    ++s_frame.batches;
+    s_batch.clear();
+}
+
+void endFrame() {
+    flush();
+    s_stream.endFrame();
+    GLState::endFrame();
+    s_frame.bytesStreamed = s_stream.getStats().bytes;
+    s_frame.fenceWaitMs = s_stream.getStats().fenceWaitMs;
+    s_lastFrame = s_frame;
+    s_frame = {};
+}
+
+const FrameStats& getFrameStats() {
+    return s_lastFrame;
+}
 
-    static bool lastUseTex = false;
-    bool useTex = texture != 0;
-    GLint locUse = glGetUniformLocation(prog, "uUseTex");
-    GLint locTex = glGetUniformLocation(prog, "uTex");
+void setBatching(bool enabled) {
+    flush();
+    s_batching = enabled;
+}
+
+bool isBatching() {
+    return s_batching;
+}
 
-    if (locUse >= 0 && lastUseTex != useTex) {
-        glUniform1i(locUse, useTex);
-        lastUseTex = useTex;
+void setProjection(float width, float height) {
+    if (width == s_projW && height == s_projH) return;
+    if (width <= 0.f || height <= 0.f) return;
+    flush();
+    s_projW = width;
+    s_projH = height;
+
+    // column-major ortho, (0,0) top-left, y down
+    const GLfloat proj[16] = {
+        2.f / width, 0.f,           0.f, 0.f,
+        0.f,         -2.f / height, 0.f, 0.f,
+        0.f,         0.f,           1.f, 0.f,
+        -1.f,        1.f,           0.f, 1.f,
+    };
+    for (GLuint prog : { s_program, s_programSDF, s_programSprite }) {
+        if (!prog) continue;
+        GLint loc = GLState::uniformLocation(prog, "uProjection");
+        if (loc < 0) continue;
+        GLState::useProgram(prog);
+        glUniformMatrix4fv(loc, 1, GL_FALSE, proj);
     }
+}
+
+void setPremultipliedTarget(bool enabled) {
+    flush();
+    s_premultipliedTarget = enabled;
+}
+
+void setInstancing(bool enabled) {
+    flush();
+    s_instancing = enabled;
+}
 
-    if (useTex && locTex >= 0) {
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glUniform1i(locTex, 0);
+bool isInstancing() {
+    return s_instancing && s_programSprite;
+}
+
+void forgetTexture(GLuint texture) {
+    if (texture && s_key.texture == texture) flush();
+}
+
+// float Vertex input is packed here, PackedVertex input is copied as is
+template <typename V>
+static void append(GLenum mode, const V* verts, size_t count, GLuint texture, bool sdf, Blend blend) {
+    if (!s_program || !s_vao || !s_stream.getBuffer() || !verts || count == 0) return;
+
+    BatchKey key{ mode, texture, sdf, blend };
+    bool mergeable = isMergeable(mode, count);
+    if (!batchEmpty() && (!mergeable || key != s_key || s_batch.size() + count > MAX_BATCH_VERTICES)) {
+        flush();
     }
 
-    glDrawArrays(mode, 0, (GLsizei)count);
+    s_key = key;
+    s_batch.insert(s_batch.end(), verts, verts + count);
+    ++s_frame.draws;
+    s_frame.vertices += count;
 
-    glBindVertexArray(0);
-    glUseProgram(0);
+    if (!mergeable || !s_batching) flush();
 }
 
+void draw(GLenum mode, const Vertex* verts, size_t count, GLuint texture, bool sdf, Blend blend) {
+    append(mode, verts, count, texture, sdf, blend);
+}
 
-void drawTriangles(const Vertex* verts, size_t count, GLuint texture, bool sdf) {
-    draw(GL_TRIANGLES, verts, count, texture, sdf);
+void draw(GLenum mode, const PackedVertex* verts, size_t count, GLuint texture, bool sdf, Blend blend) {
+    append(mode, verts, count, texture, sdf, blend);
 }
 
-void drawTriangles(const std::vector<Vertex>& verts, GLuint texture, bool sdf) {
-    draw(GL_TRIANGLES, verts.data(), verts.size(), texture, sdf);
+void drawQuads(const PackedVertex* verts, size_t quadCount, GLuint texture, bool sdf, Blend blend) {
+    // a single call bigger than a batch gets split
+    while (quadCount > MAX_BATCH_QUADS) {
+        append(MODE_QUADS, verts, MAX_BATCH_QUADS * 4, texture, sdf, blend);
+        verts += MAX_BATCH_QUADS * 4;
+        quadCount -= MAX_BATCH_QUADS;
+    }
+    append(MODE_QUADS, verts, quadCount * 4, texture, sdf, blend);
+}
+
+// the old per-corner path, for when instancing is off or unavailable
+static void expandSprite(const Sprite& sprite, PackedVertex quad[4]) {
+    float c = std::cos(sprite.rotation), s = std::sin(sprite.rotation);
+    for (int i = 0; i < 4; ++i) {
+        int cx = i == 1 || i == 2, cy = i >= 2;
+        float lx = sprite.offsetX + cx * sprite.width, ly = sprite.offsetY + cy * sprite.height;
+        PackedVertex& v = quad[i];
+        v.x = sprite.x + lx * c - ly * s;
+        v.y = sprite.y + lx * s + ly * c;
+        v.u = cx ? sprite.u1 : sprite.u0;
+        v.v = cy ? sprite.v1 : sprite.v0;
+        v.r = sprite.r; v.g = sprite.g; v.b = sprite.b; v.a = sprite.a;
+    }
+}
+
+void drawSprites(const Sprite* sprites, size_t count, GLuint texture, Blend blend) {
+    if (!sprites || count == 0) return;
+    if (!isInstancing()) {
+        PackedVertex quad[4];
+        for (size_t i = 0; i < count; ++i) {
+            expandSprite(sprites[i], quad);
+            drawQuads(quad, 1, texture, false, blend);
+        }
+        return;
+    }
+    if (!s_stream.getBuffer()) return;
+
+    BatchKey key{ MODE_SPRITES, texture, false, blend };
+    ++s_frame.draws;
+    s_frame.sprites += count;
+    while (count > 0) {
+        if (!batchEmpty() && (key != s_key || s_sprites.size() == MAX_BATCH_SPRITES)) flush();
+        s_key = key;
+        size_t n = std::min(count, MAX_BATCH_SPRITES - s_sprites.size());
+        s_sprites.insert(s_sprites.end(), sprites, sprites + n);
+        sprites += n;
+        count -= n;
+    }
+
+    if (!s_batching) flush();
+}
+
+static void drawDebugPanel() {
+    ImGui::Text("Draws: %zu  batches: %zu  vertices: %zu  sprites: %zu  blend changes: %zu",
+        s_lastFrame.draws, s_lastFrame.batches, s_lastFrame.vertices, s_lastFrame.sprites, s_lastFrame.blendChanges);
+    ImGui::Text("Streamed: %.1f KB  fence waits: %.3f ms  (%s, %s ring)",
+        s_lastFrame.bytesStreamed / 1024.0, s_lastFrame.fenceWaitMs,
+        s_stream.isPersistent() ? "persistent map" : "unsynchronized maps",
+        Common::formatBytes(s_stream.getSize()).c_str());
+    const auto& state = GLState::getStats();
+    ImGui::Text("GL state calls: %zu issued, %zu redundant skipped", state.issued, state.redundant);
+    bool batching = s_batching;
+    if (ImGui::Checkbox("Batching", &batching)) setBatching(batching);
+    bool instancing = s_instancing;
+    if (ImGui::Checkbox("Instanced sprites", &instancing)) setInstancing(instancing);
+}
+
+
+void drawTriangles(const Vertex* verts, size_t count, GLuint texture, bool sdf, Blend blend) {
+    draw(GL_TRIANGLES, verts, count, texture, sdf, blend);
+}
+
+void drawTriangles(const std::vector<Vertex>& verts, GLuint texture, bool sdf, Blend blend) {
+    draw(GL_TRIANGLES, verts.data(), verts.size(), texture, sdf, blend);
+}
+
+void drawTriangles(const std::vector<PackedVertex>& verts, GLuint texture, bool sdf, Blend blend) {
+    draw(GL_TRIANGLES, verts.data(), verts.size(), texture, sdf, blend);
+}
+
+// Uploads and draws the same screen filling quad grid from its own buffer in
+// each layout, with glFinish around every step so the timings cover the GPU
+// side too. Small translucent quads keep fill rate from dominating.
+template <typename V>
+static bool benchmarkLayout(const char* name, const std::vector<V>& verts, int iterations, void (*setAttribs)()) {
+    GLuint vao = 0, vbo = 0;
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    GLState::bindVertexArray(vao);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, vbo);
+    GLsizeiptr bytes = (GLsizeiptr)(verts.size() * sizeof(V));
+    glBufferData(GL_ARRAY_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+    setAttribs();
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, s_quadIndices);
+
+    using Clock = std::chrono::steady_clock;
+    GLsizei indexCount = (GLsizei)(verts.size() / 4 * 6);
+    double uploadMs = 0.0, drawMs = 0.0;
+    glFinish();
+    for (int i = 0; i < iterations; ++i) {
+        auto t0 = Clock::now();
+        glBufferData(GL_ARRAY_BUFFER, bytes, nullptr, GL_STREAM_DRAW); // orphan
+        glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, verts.data());
+        glFinish();
+        auto t1 = Clock::now();
+        glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_SHORT, nullptr);
+        glFinish();
+        auto t2 = Clock::now();
+        uploadMs += std::chrono::duration<double, std::milli>(t1 - t0).count();
+        drawMs += std::chrono::duration<double, std::milli>(t2 - t1).count();
+    }
+
+    GLState::bindVertexArray(0);
+    GLState::forgetBuffer(vbo);
+    GLState::forgetVertexArray(vao);
+    glDeleteBuffers(1, &vbo);
+    glDeleteVertexArrays(1, &vao);
+
+    GLenum err = glGetError();
+    double totalBytes = (double)bytes * iterations;
+    double totalVerts = (double)verts.size() * iterations;
+    char buf[256];
+    std::snprintf(buf, sizeof buf,
+        "GL2D bench %-6s %2zu B/vertex: upload %8.1f MB/s (%.3f ms/iter), draw %8.1f Mverts/s (%.3f ms/iter)%s",
+        name, sizeof(V),
+        uploadMs > 0.0 ? totalBytes / (1024.0 * 1024.0) / (uploadMs / 1000.0) : 0.0, uploadMs / iterations,
+        drawMs > 0.0 ? totalVerts / 1e6 / (drawMs / 1000.0) : 0.0, drawMs / iterations,
+        err != GL_NO_ERROR ? " [GL error]" : "");
+    Common::info(buf);
+    return err == GL_NO_ERROR;
+}
+
+int benchmarkVertexFormats(int quads, int iterations) {
+    if (!s_program || !s_quadIndices) {
+        Common::error("GL2D bench: renderer not initialised");
+        return 1;
+    }
+    quads = quads < 1 ? 1 : quads > (int)MAX_BATCH_QUADS ? (int)MAX_BATCH_QUADS : quads;
+    iterations = iterations < 1 ? 1 : iterations;
+    flush();
+
+    std::vector<Vertex> floats;
+    floats.reserve((size_t)quads * 4);
+    setProjection((float)Common::width, (float)Common::height);
+    int cols = 128;
+    float w = (float)Common::width / cols, h = (float)Common::height / ((quads + cols - 1) / cols);
+    for (int q = 0; q < quads; ++q) {
+        float x = (q % cols) * w, y = (q / cols) * h;
+        float r = (q % 7) / 6.0f, g = (q % 5) / 4.0f, b = (q % 3) / 2.0f;
+        floats.push_back({ x,     y,     0.f, 0.f, r, g, b, 0.25f });
+        floats.push_back({ x + w, y,     1.f, 0.f, r, g, b, 0.25f });
+        floats.push_back({ x + w, y + h, 1.f, 1.f, r, g, b, 0.25f });
+        floats.push_back({ x,     y + h, 0.f, 1.f, r, g, b, 0.25f });
+    }
+    std::vector<PackedVertex> packed(floats.begin(), floats.end());
+
+    GLState::useProgram(s_program);
+    if (s_locUseTex >= 0) glUniform1i(s_locUseTex, 0);
+    GLState::setBlendEnabled(true);
+    GLState::setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    char buf[128];
+    std::snprintf(buf, sizeof buf, "GL2D bench: %d quads, %d iterations per layout", quads, iterations);
+    Common::info(buf);
+    bool ok = benchmarkLayout("float", floats, iterations, setFloatAttribs);
+    ok = benchmarkLayout("packed", packed, iterations, setPackedAttribs) && ok;
+
+    s_lastUseTex = -1;
+    return ok ? 0 : 1;
 }
 
 } // namespace GL2D
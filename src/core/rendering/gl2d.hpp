@@ -4,6 +4,7 @@
 #include <vector>
 
 #include <cstddef>
+#include <cstdint>
 
 namespace Core {
 namespace Rendering {
@@ -19,16 +20,125 @@ struct Vertex {
 } __attribute__((aligned(16)));
 #endif
 
+// What the batcher stores and uploads: float position, 16-bit normalised UV
+// and 8-bit RGBA, 16 bytes instead of Vertex's 32. Built from the same eight
+// floats, so it brace-initialises like a Vertex. Plain Vertex input still
+// works and gets packed on the way in.
+struct PackedVertex {
+    float x, y;
+    uint16_t u, v;
+    uint8_t r, g, b, a;
+
+    PackedVertex() = default;
+    PackedVertex(float x, float y, float u, float v, float r, float g, float b, float a)
+        : x(x), y(y), u(unorm16(u)), v(unorm16(v)), r(unorm8(r)), g(unorm8(g)), b(unorm8(b)), a(unorm8(a)) {}
+    PackedVertex(const Vertex& vert)
+        : PackedVertex(vert.x, vert.y, vert.u, vert.v, vert.r, vert.g, vert.b, vert.a) {}
+
+    static uint16_t unorm16(float f) { return (uint16_t)((f <= 0.f ? 0.f : f >= 1.f ? 1.f : f) * 65535.f + 0.5f); }
+    static uint8_t unorm8(float f) { return (uint8_t)((f <= 0.f ? 0.f : f >= 1.f ? 1.f : f) * 255.f + 0.5f); }
+};
+static_assert(sizeof(PackedVertex) == 16, "PackedVertex is meant to be 16 bytes");
+
+// One instance for drawSprites(). The vertex shader expands it into a quad,
+// so anchoring, rotation and the projection run on the GPU. The quad
+// spans offset .. offset + size around the pivot (game pixels, y down),
+// rotated about the pivot; a negative size mirrors it.
+struct Sprite {
+    float x, y;             // pivot
+    float offsetX, offsetY; // top-left corner relative to the pivot, before rotation
+    float width, height;
+    float rotation;         // radians, clockwise on screen
+    uint16_t u0, v0, u1, v1;
+    uint8_t r, g, b, a;
+
+    void setUV(float s0, float t0, float s1, float t1) {
+        u0 = PackedVertex::unorm16(s0); v0 = PackedVertex::unorm16(t0);
+        u1 = PackedVertex::unorm16(s1); v1 = PackedVertex::unorm16(t1);
+    }
+    void setColor(float red, float green, float blue, float alpha) {
+        r = PackedVertex::unorm8(red); g = PackedVertex::unorm8(green);
+        b = PackedVertex::unorm8(blue); a = PackedVertex::unorm8(alpha);
+    }
+};
+static_assert(sizeof(Sprite) == 40, "Sprite is meant to be 40 bytes");
+
+// Blend factors, part of every draw. Blending is always on; plain alpha
+// blending is the default.
+struct Blend {
+    GLenum src = GL_SRC_ALPHA;
+    GLenum dst = GL_ONE_MINUS_SRC_ALPHA;
+
+    bool operator==(const Blend& other) const { return src == other.src && dst == other.dst; }
+    bool operator!=(const Blend& other) const { return !(*this == other); }
+};
+
+// Draws are batched: vertices are appended to a CPU-side buffer and only
+// sent to GL when the texture, program, blend factors or primitive type
+// change, when flush() is called, or at endFrame(). Anything that changes
+// GL state behind GL2D's back (viewport, framebuffer) has to flush() first.
+struct FrameStats {
+    size_t draws = 0;     // draw() calls
+    size_t batches = 0;   // glDraw* calls they turned into
+    size_t vertices = 0;
+    size_t sprites = 0;   // drawn as instances
+    size_t blendChanges = 0;    // batches that needed different blend factors than the one before
+    size_t bytesStreamed = 0;
+    double fenceWaitMs = 0.0;   // blocked on ring segments the GPU still used
+};
+
 bool init();
 void shutdown();
 
-void draw(GLenum mode, const Vertex* verts, size_t count, GLuint texture = 0, bool sdf = false);
-inline void draw(GLenum mode, const std::vector<Vertex>& verts, GLuint texture = 0, bool sdf = false) {
-    if (!verts.empty()) draw(mode, verts.data(), verts.size(), texture, sdf);
+void flush();
+void endFrame();
+const FrameStats& getFrameStats(); // the last finished frame
+
+// Maps game-space pixels ((0,0) top-left, y down) to the viewport. All
+// vertices and sprites are given in these units. Only re-uploaded when the
+// size changes, so it's fine to call every frame.
+void setProjection(float width, float height);
+
+// flushes after every draw when off, for comparing against the old path
+void setBatching(bool enabled);
+bool isBatching();
+
+// For drawing into a transparent offscreen target that gets composited
+// later with Blend{ GL_ONE, GL_ONE_MINUS_SRC_ALPHA }: colour still blends
+// with each draw's own factors, alpha accumulates as ONE, ONE_MINUS_SRC_ALPHA,
+// which leaves premultiplied colour and correct coverage in the target.
+void setPremultipliedTarget(bool enabled);
+
+// sprites are expanded into quads on the CPU when off
+void setInstancing(bool enabled);
+bool isInstancing();
+
+// a texture is about to be deleted, don't leave it queued
+void forgetTexture(GLuint texture);
+
+void draw(GLenum mode, const Vertex* verts, size_t count, GLuint texture = 0, bool sdf = false, Blend blend = {});
+void draw(GLenum mode, const PackedVertex* verts, size_t count, GLuint texture = 0, bool sdf = false, Blend blend = {});
+inline void draw(GLenum mode, const std::vector<Vertex>& verts, GLuint texture = 0, bool sdf = false, Blend blend = {}) {
+    if (!verts.empty()) draw(mode, verts.data(), verts.size(), texture, sdf, blend);
 }
+inline void draw(GLenum mode, const std::vector<PackedVertex>& verts, GLuint texture = 0, bool sdf = false, Blend blend = {}) {
+    if (!verts.empty()) draw(mode, verts.data(), verts.size(), texture, sdf, blend);
+}
+
+// 4 vertices per quad (corners in order around it), drawn indexed from a
+// static element buffer, so a third less vertex data than two triangles
+void drawQuads(const PackedVertex* verts, size_t quadCount, GLuint texture = 0, bool sdf = false, Blend blend = {});
+
+// one glDrawArraysInstanced per texture/blend run; texture must be non-zero
+void drawSprites(const Sprite* sprites, size_t count, GLuint texture, Blend blend = {});
+
+void drawTriangles(const Vertex* verts, size_t count, GLuint texture = 0, bool sdf = false, Blend blend = {});
+void drawTriangles(const std::vector<Vertex>& verts, GLuint texture = 0, bool sdf = false, Blend blend = {});
+void drawTriangles(const std::vector<PackedVertex>& verts, GLuint texture = 0, bool sdf = false, Blend blend = {});
 
-void drawTriangles(const Vertex* verts, size_t count, GLuint texture = 0, bool sdf = false);
-void drawTriangles(const std::vector<Vertex>& verts, GLuint texture = 0, bool sdf = false);
+// --bench-vertex: times uploading and drawing the same quads in the float
+// Vertex layout and the PackedVertex one, logs both. Returns an exit code.
+int benchmarkVertexFormats(int quads = 16384, int iterations = 200);
 
 } // namespace GL2D
 } // namespace Rendering
@@ -0,0 +1,151 @@
+#include "glState.hpp"
+
+#include <string>
+#include <unordered_map>
+
+namespace Core {
+namespace Rendering {
+namespace GLState {
+
+namespace {
+
+// 0 is a real binding, so "unknown" needs its own value
+constexpr GLuint UNKNOWN = ~0u;
+
+struct Shadow {
+    GLuint program = UNKNOWN;
+    GLuint vao = UNKNOWN;
+    GLuint arrayBuffer = UNKNOWN;
+    int activeUnit = -1;
+    GLuint textures[MAX_TEXTURE_UNITS] = { UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN };
+    int blendEnabled = -1;
+    GLenum blendSrc = UNKNOWN;
+    GLenum blendDst = UNKNOWN;
+    GLenum blendSrcAlpha = UNKNOWN;
+    GLenum blendDstAlpha = UNKNOWN;
+    int viewport[4] = { -1, -1, -1, -1 };
+};
+
+Shadow shadow;
+Stats frame;
+Stats lastFrame;
+std::unordered_map<GLuint, std::unordered_map<std::string, GLint>> uniforms;
+
+// true when the call has to go through
+bool changed(bool differs) {
+    if (differs) ++frame.issued;
+    else ++frame.redundant;
+    return differs;
+}
+
+} // namespace
+
+void useProgram(GLuint program) {
+    if (!changed(shadow.program != program)) return;
+    glUseProgram(program);
+    shadow.program = program;
+}
+
+void bindVertexArray(GLuint vao) {
+    if (!changed(shadow.vao != vao)) return;
+    glBindVertexArray(vao);
+    shadow.vao = vao;
+}
+
+void bindBuffer(GLenum target, GLuint buffer) {
+    if (target != GL_ARRAY_BUFFER) {
+        glBindBuffer(target, buffer);
+        return;
+    }
+    if (!changed(shadow.arrayBuffer != buffer)) return;
+    glBindBuffer(target, buffer);
+    shadow.arrayBuffer = buffer;
+}
+
+void bindTexture(int unit, GLuint texture) {
+    if (unit < 0 || unit >= MAX_TEXTURE_UNITS) return;
+    if (!changed(shadow.textures[unit] != texture)) return;
+    if (shadow.activeUnit != unit) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        shadow.activeUnit = unit;
+    }
+    glBindTexture(GL_TEXTURE_2D, texture);
+    shadow.textures[unit] = texture;
+}
+
+void setBlendEnabled(bool enabled) {
+    if (!changed(shadow.blendEnabled != (int)enabled)) return;
+    if (enabled) glEnable(GL_BLEND);
+    else glDisable(GL_BLEND);
+    shadow.blendEnabled = enabled;
+}
+
+void setBlendFunc(GLenum src, GLenum dst) {
+    setBlendFuncSeparate(src, dst, src, dst);
+}
+
+void setBlendFuncSeparate(GLenum src, GLenum dst, GLenum srcAlpha, GLenum dstAlpha) {
+    if (!changed(shadow.blendSrc != src || shadow.blendDst != dst ||
+                 shadow.blendSrcAlpha != srcAlpha || shadow.blendDstAlpha != dstAlpha)) return;
+    glBlendFuncSeparate(src, dst, srcAlpha, dstAlpha);
+    shadow.blendSrc = src;
+    shadow.blendDst = dst;
+    shadow.blendSrcAlpha = srcAlpha;
+    shadow.blendDstAlpha = dstAlpha;
+}
+
+void viewport(int x, int y, int width, int height) {
+    int* vp = shadow.viewport;
+    if (!changed(vp[0] != x || vp[1] != y || vp[2] != width || vp[3] != height)) return;
+    glViewport(x, y, width, height);
+    vp[0] = x;
+    vp[1] = y;
+    vp[2] = width;
+    vp[3] = height;
+}
+
+GLint uniformLocation(GLuint program, const char* name) {
+    auto& locations = uniforms[program];
+    auto it = locations.find(name);
+    if (it != locations.end()) return it->second;
+    GLint location = glGetUniformLocation(program, name);
+    locations.emplace(name, location);
+    return location;
+}
+
+void forgetProgram(GLuint program) {
+    uniforms.erase(program);
+    if (shadow.program == program) shadow.program = UNKNOWN;
+}
+
+void forgetTexture(GLuint texture) {
+    // GL unbinds a deleted texture from every unit
+    for (auto& bound : shadow.textures) {
+        if (bound == texture) bound = UNKNOWN;
+    }
+}
+
+void forgetBuffer(GLuint buffer) {
+    if (shadow.arrayBuffer == buffer) shadow.arrayBuffer = UNKNOWN;
+}
+
+void forgetVertexArray(GLuint vao) {
+    if (shadow.vao == vao) shadow.vao = UNKNOWN;
+}
+
+void invalidate() {
+    shadow = {};
+}
+
+void endFrame() {
+    lastFrame = frame;
+    frame = {};
+}
+
+const Stats& getStats() {
+    return lastFrame;
+}
+
+} // namespace GLState
+} // namespace Rendering
+} // namespace Core
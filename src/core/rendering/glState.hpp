@@ -0,0 +1,47 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+
+namespace Core {
+namespace Rendering {
+namespace GLState {
+
+// Shadows the bits of GL state the renderer touches and only calls into GL
+// when something actually changes. Anything that changes this state behind
+// its back has to invalidate() afterwards (ImGui, for one, restores its own
+// backup), and deleted objects have to be forgotten so a recycled name
+// isn't mistaken for one that's still bound.
+struct Stats {
+    size_t issued = 0;      // state calls that reached GL
+    size_t redundant = 0;   // state calls skipped because nothing changed
+};
+
+constexpr int MAX_TEXTURE_UNITS = 8;
+
+void useProgram(GLuint program);
+void bindVertexArray(GLuint vao);
+void bindBuffer(GLenum target, GLuint buffer);  // GL_ARRAY_BUFFER only is shadowed, others go straight through
+void bindTexture(int unit, GLuint texture);     // GL_TEXTURE_2D
+void setBlendEnabled(bool enabled);
+void setBlendFunc(GLenum src, GLenum dst);
+void setBlendFuncSeparate(GLenum src, GLenum dst, GLenum srcAlpha, GLenum dstAlpha);
+void viewport(int x, int y, int width, int height);
+
+// looked up once per program and name
+GLint uniformLocation(GLuint program, const char* name);
+
+void forgetProgram(GLuint program);
+void forgetTexture(GLuint texture);
+void forgetBuffer(GLuint buffer);
+void forgetVertexArray(GLuint vao);
+
+// next call of every kind goes through to GL
+void invalidate();
+
+void endFrame();
+const Stats& getStats(); // the last finished frame
+
+} // namespace GLState
+} // namespace Rendering
+} // namespace Core
@@ -0,0 +1,227 @@
+#include "gpuProfiler.hpp"
+#include "gl2d.hpp"
+#include <common/log.hpp>
+#include <core/debug.hpp>
+#include <glad/glad.h>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <imgui.h>
+
+namespace Core {
+namespace Rendering {
+namespace GPUProfiler {
+
+struct Sample {
+    const char* name;
+    int depth;
+    float ms;
+};
+
+struct FrameSlot {
+    GLuint queries[MAX_SCOPES * 2] = {};
+    const char* names[MAX_SCOPES] = {};
+    int depths[MAX_SCOPES] = {};
+    bool closed[MAX_SCOPES] = {};
+    int count = 0;
+    GLuint lastQuery = 0;   // issued last, so available means all of them are
+    uint64_t frame = 0;
+    bool pending = false;
+};
+
+struct ResolvedFrame {
+    uint64_t frame = 0;
+    std::vector<Sample> samples;
+};
+
+constexpr int MAX_DEPTH = 16;
+
+static FrameSlot s_slots[FRAMES_IN_FLIGHT];
+static bool s_initialized = false;
+static bool s_enabled = true;
+static bool s_inFrame = false;
+static uint64_t s_frame = 0;
+
+static int s_stack[MAX_DEPTH];
+static int s_stackDepth = 0;
+static int s_skippedDepth = 0;  // scopes opened past MAX_SCOPES / MAX_DEPTH, ignored on end()
+
+static std::vector<ResolvedFrame> s_history;   // ring of HISTORY_FRAMES
+static size_t s_historyNext = 0;
+static ResolvedFrame s_latest;
+static std::unordered_set<std::string> s_names;  // interned, so results outlive the caller's string
+static std::unordered_map<std::string, float> s_average;   // ms, smoothed
+static size_t s_droppedFrames = 0;  // results still not ready when the slot came round again
+static size_t s_droppedScopes = 0;
+
+static void drawDebugPanel();
+
+void init() {
+    if (s_initialized) return;
+    for (FrameSlot& slot : s_slots) glGenQueries(MAX_SCOPES * 2, slot.queries);
+    s_history.resize(HISTORY_FRAMES);
+    s_initialized = true;
+    Core::Debug::addPanel("GPU", drawDebugPanel);
+}
+
+void shutdown() {
+    if (!s_initialized) return;
+    Core::Debug::removePanel("GPU");
+    for (FrameSlot& slot : s_slots) {
+        glDeleteQueries(MAX_SCOPES * 2, slot.queries);
+        slot = {};
+    }
+    s_history.clear();
+    s_latest = {};
+    s_average.clear();
+    s_names.clear();
+    s_initialized = false;
+}
+
+static void resolve(FrameSlot& slot) {
+    slot.pending = false;
+
+    GLint available = 0;
+    glGetQueryObjectiv(slot.lastQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+        ++s_droppedFrames;
+        return;
+    }
+
+    ResolvedFrame resolved;
+    resolved.frame = slot.frame;
+    resolved.samples.reserve(slot.count);
+    for (int i = 0; i < slot.count; ++i) {
+        if (!slot.closed[i]) continue;
+        GLuint64 start = 0, end = 0;
+        glGetQueryObjectui64v(slot.queries[i * 2], GL_QUERY_RESULT, &start);
+        glGetQueryObjectui64v(slot.queries[i * 2 + 1], GL_QUERY_RESULT, &end);
+        float ms = end > start ? (float)((end - start) / 1e6) : 0.f;
+        resolved.samples.push_back({ slot.names[i], slot.depths[i], ms });
+
+        auto [it, inserted] = s_average.try_emplace(slot.names[i], ms);
+        if (!inserted) it->second += (ms - it->second) * 0.05f;
+    }
+
+    s_latest = resolved;
+    s_history[s_historyNext] = std::move(resolved);
+    s_historyNext = (s_historyNext + 1) % HISTORY_FRAMES;
+}
+
+void beginFrame() {
+    if (!s_initialized || !s_enabled) return;
+
+    FrameSlot& slot = s_slots[s_frame % FRAMES_IN_FLIGHT];
+    if (slot.pending) resolve(slot);
+    slot.count = 0;
+    slot.lastQuery = 0;
+    slot.frame = s_frame;
+
+    s_stackDepth = 0;
+    s_skippedDepth = 0;
+    s_inFrame = true;
+}
+
+void endFrame() {
+    if (!s_inFrame) return;
+    while (s_stackDepth > 0) end(); // unbalanced scopes close with the frame
+    s_inFrame = false;
+
+    FrameSlot& slot = s_slots[s_frame % FRAMES_IN_FLIGHT];
+    slot.pending = slot.count > 0;
+    ++s_frame;
+}
+
+void begin(const char* name) {
+    if (!s_inFrame) return;
+    FrameSlot& slot = s_slots[s_frame % FRAMES_IN_FLIGHT];
+    if (s_skippedDepth > 0 || slot.count >= MAX_SCOPES || s_stackDepth >= MAX_DEPTH) {
+        ++s_skippedDepth;
+        ++s_droppedScopes;
+        return;
+    }
+
+    GL2D::flush();
+    int index = slot.count++;
+    slot.names[index] = s_names.emplace(name).first->c_str();
+    slot.depths[index] = s_stackDepth;
+    slot.closed[index] = false;
+    glQueryCounter(slot.queries[index * 2], GL_TIMESTAMP);
+    slot.lastQuery = slot.queries[index * 2];
+    s_stack[s_stackDepth++] = index;
+}
+
+void end() {
+    if (!s_inFrame) return;
+    if (s_skippedDepth > 0) {
+        --s_skippedDepth;
+        return;
+    }
+    if (s_stackDepth == 0) return;
+
+    FrameSlot& slot = s_slots[s_frame % FRAMES_IN_FLIGHT];
+    int index = s_stack[--s_stackDepth];
+    GL2D::flush();
+    glQueryCounter(slot.queries[index * 2 + 1], GL_TIMESTAMP);
+    slot.lastQuery = slot.queries[index * 2 + 1];
+    slot.closed[index] = true;
+}
+
+void setEnabled(bool enabled) {
+    if (!enabled && s_inFrame) endFrame();
+    s_enabled = enabled;
+}
+
+bool isEnabled() {
+    return s_enabled;
+}
+
+bool dumpCSV(const std::string& path) {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        Common::error("GPUProfiler: can't write " + path);
+        return false;
+    }
+
+    out << "frame,scope,depth,gpu_ms\n";
+    size_t rows = 0;
+    // oldest first, the ring may not be full yet
+    for (size_t i = 0; i < s_history.size(); ++i) {
+        const ResolvedFrame& frame = s_history[(s_historyNext + i) % s_history.size()];
+        for (const Sample& sample : frame.samples) {
+            out << frame.frame << ',' << sample.name << ',' << sample.depth << ',' << sample.ms << '\n';
+            ++rows;
+        }
+    }
+
+    char buf[256];
+    std::snprintf(buf, sizeof buf, "GPUProfiler: wrote %zu samples to %s", rows, path.c_str());
+    Common::info(buf);
+    return true;
+}
+
+static void drawDebugPanel() {
+    bool enabled = s_enabled;
+    if (ImGui::Checkbox("Timer queries", &enabled)) setEnabled(enabled);
+    ImGui::SameLine();
+    if (ImGui::Button("Dump CSV")) dumpCSV("gpu_profile.csv");
+
+    ImGui::Text("Frame %llu (%d frames behind), %zu frames dropped, %zu scopes dropped",
+        (unsigned long long)s_latest.frame, FRAMES_IN_FLIGHT, s_droppedFrames, s_droppedScopes);
+    for (const Sample& sample : s_latest.samples) {
+        auto it = s_average.find(sample.name);
+        // Indent(0) would mean ImGui's default step
+        float indent = 12.0f * sample.depth;
+        if (indent > 0.0f) ImGui::Indent(indent);
+        ImGui::Text("%s: %.3f ms (avg %.3f)", sample.name, sample.ms, it != s_average.end() ? it->second : sample.ms);
+        if (indent > 0.0f) ImGui::Unindent(indent);
+    }
+}
+
+} // namespace GPUProfiler
+} // namespace Rendering
+} // namespace Core
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+
+namespace Core {
+namespace Rendering {
+namespace GPUProfiler {
+
+// GPU time per named scope, from GL_TIMESTAMP queries written at the start
+// and end of each scope. Queries live in a ring a few frames deep and are
+// only read once GL says they're available, so the numbers show up
+// FRAMES_IN_FLIGHT frames late but never stall the pipeline. Scopes nest
+// and can be opened from anywhere between beginFrame() and endFrame(),
+// a state's render() included.
+//
+// Opening or closing a scope flushes GL2D so batched draws land in the
+// scope that issued them. Work submitted to the RenderQueue is drawn at its
+// flush, so it's counted wherever that happens, not where it was submitted.
+constexpr int FRAMES_IN_FLIGHT = 4;
+constexpr int MAX_SCOPES = 64;      // per frame, the rest are dropped
+constexpr int HISTORY_FRAMES = 600; // kept for dumpCSV()
+
+void init();
+void shutdown();
+
+void beginFrame();
+void endFrame();
+
+void begin(const char* name); // copied, any string will do
+void end();
+
+class Scope {
+public:
+    explicit Scope(const char* name) { begin(name); }
+    ~Scope() { end(); }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+};
+
+void setEnabled(bool enabled);
+bool isEnabled();
+
+// frame,scope,depth,gpu_ms for every frame in the history
+bool dumpCSV(const std::string& path);
+
+} // namespace GPUProfiler
+} // namespace Rendering
+} // namespace Core
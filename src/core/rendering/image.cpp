@@ -4,7 +4,9 @@
 #include <SDL3_image/SDL_image.h>
 #include <SDL3/SDL.h>
 #include <cmath>
+#include <cstring>
 #include <core/rendering/gl2d.hpp>
+#include <core/rendering/renderQueue.hpp>
 
 namespace Core {
 namespace Rendering {
@@ -16,7 +18,8 @@ namespace Rendering {
 #endif
 
 Image::Image() 
-    : m_textureID(0), m_width(0), m_height(0)
+    : m_u0(0.0f), m_v0(0.0f), m_u1(1.0f), m_v1(1.0f)
+    , m_width(0), m_height(0)
     , m_tintR(1.0f), m_tintG(1.0f), m_tintB(1.0f), m_tintA(1.0f)
     , m_hasTint(false) {
 }
@@ -26,31 +29,135 @@ Image::~Image() {
 }
 
 bool Image::load(const std::string& filepath) {
+    PixelData data;
+    if (!decode(filepath, data)) return false;
+
+    return loadFromPixels(data.pixels.data(), data.width, data.height);
+}
+
+bool Image::loadFromPixels(const unsigned char* pixels, int width, int height) {
     cleanup();
 
-    SDL_Surface* surface = IMG_Load(filepath.c_str());
+    auto texture = Texture::create(pixels, width, height);
+    if (!texture) {
+        Common::error("Unable to create texture for image");
+        return false;
+    }
+
+    setTexture(std::move(texture));
+    m_width = width;
+    m_height = height;
+
+    return true;
+}
+
+void Image::setTexture(std::shared_ptr<Texture> texture, float u0, float v0, float u1, float v1) {
+    m_texture = std::move(texture);
+    m_u0 = u0;
+    m_v0 = v0;
+    m_u1 = u1;
+    m_v1 = v1;
+}
+
+void Image::shareTexture(const Image& other) {
+    setTexture(other.m_texture, other.m_u0, other.m_v0, other.m_u1, other.m_v1);
+    m_sourceWidth = other.m_sourceWidth;
+    m_sourceHeight = other.m_sourceHeight;
+    m_trim = other.m_trim;
+}
+
+void Image::setTrim(int sourceWidth, int sourceHeight, const TrimRect& trim) {
+    m_sourceWidth = sourceWidth;
+    m_sourceHeight = sourceHeight;
+    m_trim = trim;
+}
+
+TrimRect TrimRect::find(const unsigned char* rgba, int width, int height) {
+    const size_t stride = (size_t)width * 4;
+    auto rowVisible = [&](int row) {
+        const unsigned char* p = rgba + (size_t)row * stride + 3;
+        for (int x = 0; x < width; ++x, p += 4) {
+            if (*p) return true;
+        }
+        return false;
+    };
+
+    int top = 0;
+    while (top < height && !rowVisible(top)) ++top;
+    if (top == height) return { 0, 0, 1, 1 }; // fully transparent, keep a single texel
+
+    int bottom = height - 1;
+    while (bottom > top && !rowVisible(bottom)) --bottom;
+
+    int left = width, right = -1;
+    for (int row = top; row <= bottom; ++row) {
+        const unsigned char* p = rgba + (size_t)row * stride;
+        for (int x = 0; x < left; ++x) {
+            if (p[(size_t)x * 4 + 3]) {
+                left = x;
+                break;
+            }
+        }
+        for (int x = width - 1; x > right; --x) {
+            if (p[(size_t)x * 4 + 3]) {
+                right = x;
+                break;
+            }
+        }
+    }
+
+    return { left, top, right - left + 1, bottom - top + 1 };
+}
+
+uint64_t PixelData::computeHash(const unsigned char* pixels, int width, int height) {
+    uint64_t hash = Common::hashBytes(pixels, (size_t)width * height * 4);
+    // two images with the same bytes but a different shape aren't the same texture
+    return hash ^ ((uint64_t)(uint32_t)width << 32 | (uint32_t)height) * 0x9e3779b97f4a7c15;
+}
+
+static bool surfaceToPixels(SDL_Surface* surface, PixelData& out) {
     if (!surface) {
         Common::error("Unable to load image! SDL_image Error: " + std::string(SDL_GetError()));
         return false;
     }
 
-    m_width = surface->w;
-    m_height = surface->h;
+    SDL_Surface* rgba = surface;
+    if (surface->format != SDL_PIXELFORMAT_RGBA32) {
+        rgba = SDL_ConvertSurface(surface, SDL_PIXELFORMAT_RGBA32);
+        SDL_DestroySurface(surface);
+        if (!rgba) {
+            Common::error("Unable to convert image to RGBA! SDL Error: " + std::string(SDL_GetError()));
+            return false;
+        }
+    }
 
-    glGenTextures(1, &m_textureID);
-    glBindTexture(GL_TEXTURE_2D, m_textureID);
+    out.width = rgba->w;
+    out.height = rgba->h;
 
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_width, m_height, 0,
-                 GL_RGBA, GL_UNSIGNED_BYTE, surface->pixels);
+    size_t rowBytes = (size_t)rgba->w * 4;
+    out.pixels.resize(rowBytes * rgba->h);
+    const unsigned char* src = static_cast<const unsigned char*>(rgba->pixels);
+    for (int row = 0; row < rgba->h; ++row) {
+        std::memcpy(out.pixels.data() + row * rowBytes, src + (size_t)row * rgba->pitch, rowBytes);
+    }
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    SDL_DestroySurface(rgba);
+    out.hash = PixelData::computeHash(out.pixels.data(), out.width, out.height);
+    out.trim = TrimRect::find(out.pixels.data(), out.width, out.height);
+    return true;
+}
 
-    SDL_DestroySurface(surface);
+bool Image::decode(const std::string& filepath, PixelData& out) {
+    return surfaceToPixels(IMG_Load(filepath.c_str()), out);
+}
 
-    return true;
+bool Image::decode(const void* data, size_t size, PixelData& out) {
+    SDL_IOStream* io = SDL_IOFromConstMem(data, size);
+    if (!io) {
+        Common::error("Unable to open image memory! SDL Error: " + std::string(SDL_GetError()));
+        return false;
+    }
+    return surfaceToPixels(IMG_Load_IO(io, true), out);
 }
 
 void Image::setBlendMode(BlendMode mode) {
@@ -63,32 +170,42 @@ void Image::setCustomBlend(GLenum src, GLenum dst) {
     dstFactor = dst;
 }
 
-static void applyBlendMode(const Image* img) {
+static GL2D::Blend blendFor(const Image* img) {
     switch (img->blendMode) {
         case BlendMode::Normal:
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-            break;
+            return { GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA };
 
         case BlendMode::Additive:
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-            break;
+            return { GL_SRC_ALPHA, GL_ONE };
 
         case BlendMode::Multiply:
-            glBlendFunc(GL_DST_COLOR, GL_ONE_MINUS_SRC_ALPHA);
-            break;
+            return { GL_DST_COLOR, GL_ONE_MINUS_SRC_ALPHA };
 
         case BlendMode::Screen:
-            glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_COLOR);
-            break;
+            return { GL_ONE, GL_ONE_MINUS_SRC_COLOR };
 
         case BlendMode::Custom:
-            glBlendFunc(img->srcFactor, img->dstFactor);
-            break;
+            return { img->srcFactor, img->dstFactor };
     }
+    return {};
+}
+
+void Image::render(int x, int y, int width, int height, float rotation, int /* originX */, int /* originY */) {
+    GL2D::Sprite sprite;
+    if (!buildSprite(x, y, width, height, rotation, sprite)) return;
+    // blend factors are part of the batch key, so GL only sees a change between batches
+    GL2D::drawSprites(&sprite, 1, m_texture->getID(), blendFor(this));
 }
 
-void Image::render(int x, int y, int width, int height, float rotation, int originX, int originY) {
-    if (!isLoaded()) return;
+void Image::submit(uint8_t layer, uint16_t depth, int x, int y, int width, int height, float rotation) {
+    GL2D::Sprite sprite;
+    if (!buildSprite(x, y, width, height, rotation, sprite)) return;
+    // residency may evict this image before the flush, the queue keeps the texture alive
+    RenderQueue::submit(layer, depth, sprite, m_texture, blendFor(this));
+}
+
+bool Image::buildSprite(int x, int y, int width, int height, float rotation, GL2D::Sprite& sprite) const {
+    if (!isLoaded()) return false;
 
     float w = (width == -1) ? m_width : (float)width;
     float h = (height == -1) ? m_height : (float)height;
@@ -109,31 +226,20 @@ void Image::render(int x, int y, int width, int height, float rotation, int orig
             break;
     }
 
-    float corners[4][2] = {
-        { -ox,       -oy    },
-        { w - ox,    -oy    },
-        { w - ox,    h - oy },
-        { -ox,       h - oy }
-    };
-
-    if (rotation != 0.0f) {
-        float rad = rotation * (3.14159265f / 180.f);
-        float cosR = std::cos(rad), sinR = std::sin(rad);
-        for (int i=0;i<4;i++){
-            float px = corners[i][0], py = corners[i][1];
-            corners[i][0] = px*cosR - py*sinR;
-            corners[i][1] = px*sinR + py*cosR;
-        }
-    }
-
-    for (int i=0;i<4;i++) {
-        corners[i][0] += x;
-        corners[i][1] += y;
-        std::tie(corners[i][0], corners[i][1]) = Common::screenToGLCoords(
-            (int)corners[i][0], (int)corners[i][1], Common::width, Common::height);
+    // Only the trimmed part of the image is in the texture. Work out where it
+    // sits inside the full w x h quad (mirrored along with the quad when flipped)
+    // and emit just that.
+    float s0 = 0.f, s1 = 1.f, t0 = 0.f, t1 = 1.f;
+    if (m_trim.width > 0 && m_sourceWidth > 0 && m_sourceHeight > 0) {
+        s0 = (float)m_trim.x / m_sourceWidth;
+        s1 = (float)(m_trim.x + m_trim.width) / m_sourceWidth;
+        t0 = (float)m_trim.y / m_sourceHeight;
+        t1 = (float)(m_trim.y + m_trim.height) / m_sourceHeight;
+        if (w < 0) std::tie(s0, s1) = std::make_pair(1.f - s1, 1.f - s0);
+        if (h < 0) std::tie(t0, t1) = std::make_pair(1.f - t1, 1.f - t0);
     }
 
-    float u0=0, u1=1, v0=0, v1=1;
+    float u0=m_u0, u1=m_u1, v0=m_v0, v1=m_v1;
     if (w < 0) std::swap(u0,u1);
     if (h < 0) std::swap(v0,v1);
 
@@ -142,17 +248,17 @@ void Image::render(int x, int y, int width, int height, float rotation, int orig
     float b = m_hasTint ? m_tintB : 1.f;
     float a = m_hasTint ? m_tintA : 1.f;
 
-    using namespace Core::Rendering::GL2D;
-    Vertex verts[6] = {
-        {corners[0][0], corners[0][1], u0, v0, r,g,b,a},
-        {corners[1][0], corners[1][1], u1, v0, r,g,b,a},
-        {corners[2][0], corners[2][1], u1, v1, r,g,b,a},
-        {corners[2][0], corners[2][1], u1, v1, r,g,b,a},
-        {corners[3][0], corners[3][1], u0, v1, r,g,b,a},
-        {corners[0][0], corners[0][1], u0, v0, r,g,b,a},
-    };
-
-    GL2D::drawTriangles(verts, 6, m_textureID);
+    // corners, rotation and the screen transform are left to the sprite shader
+    sprite.x = (float)x;
+    sprite.y = (float)y;
+    sprite.offsetX = s0 * w - ox;
+    sprite.offsetY = t0 * h - oy;
+    sprite.width = (s1 - s0) * w;
+    sprite.height = (t1 - t0) * h;
+    sprite.rotation = rotation * (3.14159265f / 180.f);
+    sprite.setUV(u0, v0, u1, v1);
+    sprite.setColor(r, g, b, a);
+    return true;
 }
 
 void Image::setWidth(int width) {
@@ -183,10 +289,14 @@ void Image::clearTint() {
 }
 
 void Image::cleanup() {
-    if (m_textureID != 0) {
-        glDeleteTextures(1, &m_textureID);
-        m_textureID = 0;
-    }
+    m_texture.reset();
+    m_u0 = 0.0f;
+    m_v0 = 0.0f;
+    m_u1 = 1.0f;
+    m_v1 = 1.0f;
+    m_sourceWidth = 0;
+    m_sourceHeight = 0;
+    m_trim = {};
     m_width = 0;
     m_height = 0;
 }
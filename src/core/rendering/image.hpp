@@ -4,10 +4,15 @@
 #include <glad/glad.h>
 #include <SDL3/SDL.h>
 #include <vector>
+#include <memory>
+#include <cstdint>
+#include <core/rendering/texture.hpp>
 
 namespace Core {
 namespace Rendering {
 
+namespace GL2D { struct Sprite; }
+
 enum class BlendMode {
     Normal,
     Additive,
@@ -16,6 +21,28 @@ enum class BlendMode {
     Custom
 };
 
+// Part of an image that has any visible (alpha > 0) pixels, in source pixels.
+// A zero width means "the whole image".
+struct TrimRect {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+
+    static TrimRect find(const unsigned char* rgba, int width, int height);
+};
+
+// Decoded, tightly packed RGBA8 pixels. Safe to produce off the GL thread.
+struct PixelData {
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> pixels;
+    uint64_t hash = 0; // content hash of the pixels and size, filled in by Image::decode
+    TrimRect trim;     // also filled in by Image::decode
+
+    static uint64_t computeHash(const unsigned char* pixels, int width, int height);
+};
+
 enum class AnchorMode {
     TopLeft,
     Center,
@@ -28,15 +55,36 @@ public:
     ~Image();
 
     bool load(const std::string& filepath);
+    bool loadFromPixels(const unsigned char* pixels, int width, int height);
+
+    // No GL in here, these can be called from worker threads
+    static bool decode(const std::string& filepath, PixelData& out);
+    static bool decode(const void* data, size_t size, PixelData& out);
     
     void render(int x = 0, int y = 0, int width = -1, int height = -1, float rotation = 0.0f, int originX = 0, int originY = 0);
+    // same placement as render(), but queued on RenderQueue and drawn at its flush
+    void submit(uint8_t layer, uint16_t depth, int x = 0, int y = 0, int width = -1, int height = -1, float rotation = 0.0f);
+    // the instance render() draws; false when there is nothing to draw
+    bool buildSprite(int x, int y, int width, int height, float rotation, GL2D::Sprite& out) const;
     
     int getWidth() const { return m_width; }
     int getHeight() const { return m_height; }
     void setWidth(int width);
     void setHeight(int height);
     void setDimensions(int width, int height);
-    bool isLoaded() const { return m_textureID != 0; }
+    bool isLoaded() const { return m_texture != nullptr; }
+
+    // Point this image at a (possibly shared) texture, optionally at a sub-rectangle of it
+    void setTexture(std::shared_ptr<Texture> texture, float u0 = 0.0f, float v0 = 0.0f, float u1 = 1.0f, float v1 = 1.0f);
+    // same texture, sub-rectangle and trim as other, used for byte-identical images
+    void shareTexture(const Image& other);
+
+    // The texture only holds the trim rectangle of a sourceWidth x sourceHeight
+    // image. render() still places and scales it as the whole image, so anchors,
+    // hotspots and dimensions behave exactly as if it were untrimmed.
+    void setTrim(int sourceWidth, int sourceHeight, const TrimRect& trim);
+    const std::shared_ptr<Texture>& getTexture() const { return m_texture; }
+    GLuint getTextureID() const { return m_texture ? m_texture->getID() : 0; }
     
     void setTint(float r, float g, float b, float a = 1.0f);
     void clearTint();
@@ -44,8 +92,8 @@ public:
     void unload();
 
     BlendMode blendMode = BlendMode::Normal;
-    GLenum srcFactor;
-    GLenum dstFactor;
+    GLenum srcFactor = GL_SRC_ALPHA;
+    GLenum dstFactor = GL_ONE_MINUS_SRC_ALPHA;
     void setBlendMode(BlendMode mode);
     void setCustomBlend(GLenum src, GLenum dst);
 
@@ -62,7 +110,11 @@ public:
     }
 
 private:
-    GLuint m_textureID;
+    std::shared_ptr<Texture> m_texture;
+    float m_u0, m_v0, m_u1, m_v1;
+    int m_sourceWidth = 0;
+    int m_sourceHeight = 0;
+    TrimRect m_trim;
     int m_width;
     int m_height;
     float m_tintR, m_tintG, m_tintB, m_tintA;
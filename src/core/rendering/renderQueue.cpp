@@ -0,0 +1,173 @@
+#include "renderQueue.hpp"
+#include <common/log.hpp>
+#include <core/debug.hpp>
+#include <chrono>
+#include <vector>
+
+#include <imgui.h>
+
+namespace Core {
+namespace Rendering {
+namespace RenderQueue {
+
+struct Command {
+    GL2D::Sprite sprite;
+    GLuint texture = 0;
+    std::shared_ptr<Texture> owner; // keeps texture alive until the flush
+    GL2D::Blend blend;
+    int custom = -1;    // index into s_custom, or -1 for a sprite
+};
+
+struct SortItem {
+    uint64_t key;
+    uint32_t index;
+};
+
+static std::vector<Command> s_commands;
+static std::vector<std::function<void()>> s_custom;
+static std::vector<SortItem> s_items;
+static std::vector<SortItem> s_scratch;
+static std::vector<GL2D::Sprite> s_run;
+
+// blend factor pairs seen so far, their index is what goes in the key
+static std::vector<GL2D::Blend> s_blends{ GL2D::Blend{} };
+static bool s_blendOverflowWarned = false;
+
+static Stats s_stats;
+
+static void drawDebugPanel();
+
+static uint8_t blendId(GL2D::Blend blend) {
+    for (size_t i = 0; i < s_blends.size(); ++i) {
+        if (s_blends[i] == blend) return (uint8_t)i;
+    }
+    if (s_blends.size() < 256) {
+        s_blends.push_back(blend);
+        return (uint8_t)(s_blends.size() - 1);
+    }
+    // only costs batching, the factors themselves travel with the command
+    if (!s_blendOverflowWarned) {
+        Common::warn("RenderQueue: more than 256 blend modes, sharing the last key slot");
+        s_blendOverflowWarned = true;
+    }
+    return 255;
+}
+
+void init() {
+    s_commands.reserve(4096);
+    s_items.reserve(4096);
+    Core::Debug::addPanel("Render Queue", drawDebugPanel);
+}
+
+void shutdown() {
+    Core::Debug::removePanel("Render Queue");
+    s_commands.clear();
+    s_custom.clear();
+    s_items.clear();
+    s_scratch.clear();
+    s_run.clear();
+}
+
+uint64_t makeKey(uint8_t layer, uint16_t depth, GL2D::Blend blend, GLuint texture) {
+    return ((uint64_t)layer << 56) | ((uint64_t)depth << 40) | ((uint64_t)blendId(blend) << 32) | (uint64_t)texture;
+}
+
+void submit(uint8_t layer, uint16_t depth, const GL2D::Sprite& sprite, GLuint texture, GL2D::Blend blend) {
+    s_items.push_back({ makeKey(layer, depth, blend, texture), (uint32_t)s_commands.size() });
+    Command& cmd = s_commands.emplace_back();
+    cmd.sprite = sprite;
+    cmd.texture = texture;
+    cmd.blend = blend;
+}
+
+void submit(uint8_t layer, uint16_t depth, const GL2D::Sprite& sprite, std::shared_ptr<Texture> texture, GL2D::Blend blend) {
+    submit(layer, depth, sprite, texture ? texture->getID() : 0, blend);
+    s_commands.back().owner = std::move(texture);
+}
+
+void submit(uint8_t layer, uint16_t depth, std::function<void()> draw) {
+    if (!draw) return;
+    s_items.push_back({ makeKey(layer, depth, GL2D::Blend{}, 0), (uint32_t)s_commands.size() });
+    Command& cmd = s_commands.emplace_back();
+    cmd.custom = (int)s_custom.size();
+    s_custom.push_back(std::move(draw));
+}
+
+// LSD radix sort on the key, a byte per pass. Each pass is stable, which is
+// what keeps equal keys in submission order. Passes where every key has the
+// same byte (most of them, keys rarely use all 64 bits) are skipped.
+static void radixSort(std::vector<SortItem>& items, std::vector<SortItem>& scratch) {
+    size_t n = items.size();
+    if (n < 2) return;
+    scratch.resize(n);
+
+    size_t counts[8][256] = {};
+    for (const SortItem& item : items) {
+        for (int pass = 0; pass < 8; ++pass) ++counts[pass][(item.key >> (pass * 8)) & 0xFF];
+    }
+
+    SortItem* src = items.data();
+    SortItem* dst = scratch.data();
+    for (int pass = 0; pass < 8; ++pass) {
+        size_t* count = counts[pass];
+        if (count[(src[0].key >> (pass * 8)) & 0xFF] == n) continue;
+
+        size_t offsets[256];
+        size_t sum = 0;
+        for (int b = 0; b < 256; ++b) { offsets[b] = sum; sum += count[b]; }
+        for (size_t i = 0; i < n; ++i) dst[offsets[(src[i].key >> (pass * 8)) & 0xFF]++] = src[i];
+        std::swap(src, dst);
+    }
+    if (src != items.data()) items.swap(scratch);
+}
+
+static void drawRun(GLuint texture, GL2D::Blend blend) {
+    if (s_run.empty()) return;
+    GL2D::drawSprites(s_run.data(), s_run.size(), texture, blend);
+    ++s_stats.batches;
+    s_run.clear();
+}
+
+void flush() {
+    s_stats = {};
+    s_stats.commands = s_commands.size();
+    if (s_commands.empty()) return;
+
+    auto start = std::chrono::steady_clock::now();
+    radixSort(s_items, s_scratch);
+    s_stats.sortMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    GLuint runTexture = 0;
+    GL2D::Blend runBlend;
+    for (const SortItem& item : s_items) {
+        const Command& cmd = s_commands[item.index];
+        if (cmd.custom >= 0) {
+            drawRun(runTexture, runBlend);
+            s_custom[cmd.custom]();
+            ++s_stats.batches;
+            continue;
+        }
+        if (!s_run.empty() && (cmd.texture != runTexture || cmd.blend != runBlend)) drawRun(runTexture, runBlend);
+        runTexture = cmd.texture;
+        runBlend = cmd.blend;
+        s_run.push_back(cmd.sprite);
+    }
+    drawRun(runTexture, runBlend);
+
+    s_commands.clear();
+    s_custom.clear();
+    s_items.clear();
+}
+
+const Stats& getStats() {
+    return s_stats;
+}
+
+static void drawDebugPanel() {
+    ImGui::Text("Commands: %zu  batches: %zu  sort: %.3f ms", s_stats.commands, s_stats.batches, s_stats.sortMs);
+    ImGui::Text("Blend modes keyed: %zu", s_blends.size());
+}
+
+} // namespace RenderQueue
+} // namespace Rendering
+} // namespace Core
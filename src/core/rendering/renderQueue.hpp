@@ -0,0 +1,56 @@
+#pragma once
+
+#include <core/rendering/gl2d.hpp>
+#include <core/rendering/texture.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace Core {
+namespace Rendering {
+namespace RenderQueue {
+
+// States submit draws here instead of drawing straight away. Every command
+// gets a 64-bit key, layer | depth | blend | texture from the top bit down,
+// and flush() radix-sorts the frame's commands once and hands runs of
+// sprites with the same texture and blend to GL2D as single draws.
+//
+// Layers always draw in order. Inside a layer, lower depths draw first;
+// commands that share a depth are grouped by blend and texture, so give
+// overlapping things distinct depths. The sort is stable, so identical keys
+// keep their submission order.
+enum Layer : uint8_t {
+    LAYER_BACKGROUND = 0,
+    LAYER_WORLD = 64,
+    LAYER_UI = 128,
+    LAYER_OVERLAY = 192,
+    LAYER_DEBUG = 255,
+};
+
+struct Stats {
+    size_t commands = 0;
+    size_t batches = 0;     // GL2D calls the commands turned into
+    double sortMs = 0.0;
+};
+
+void init();
+void shutdown();
+
+uint64_t makeKey(uint8_t layer, uint16_t depth, GL2D::Blend blend, GLuint texture);
+
+// The texture is only bound at flush(), so a raw name has to outlive the
+// frame. Textures residency can evict go through the shared_ptr overload,
+// which holds on to them until then.
+void submit(uint8_t layer, uint16_t depth, const GL2D::Sprite& sprite, GLuint texture, GL2D::Blend blend = {});
+void submit(uint8_t layer, uint16_t depth, const GL2D::Sprite& sprite, std::shared_ptr<Texture> texture, GL2D::Blend blend = {});
+// anything that isn't a sprite (shapes, text); runs at its place in the order
+void submit(uint8_t layer, uint16_t depth, std::function<void()> draw);
+
+// sorts and draws everything submitted since the last flush
+void flush();
+const Stats& getStats(); // the last flush
+
+} // namespace RenderQueue
+} // namespace Rendering
+} // namespace Core
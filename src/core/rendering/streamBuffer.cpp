@@ -0,0 +1,139 @@
+#include "streamBuffer.hpp"
+#include "glState.hpp"
+
+#include <SDL3/SDL.h>
+#include <common/log.hpp>
+#include <chrono>
+#include <cstring>
+
+// glad is generated for plain 3.3 core, ARB_buffer_storage gets loaded by hand
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+namespace Core {
+namespace Rendering {
+
+namespace {
+
+typedef void (APIENTRYP BufferStorageProc)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+BufferStorageProc loadBufferStorage() {
+    if (!SDL_GL_ExtensionSupported("GL_ARB_buffer_storage")) return nullptr;
+    return reinterpret_cast<BufferStorageProc>(SDL_GL_GetProcAddress("glBufferStorage"));
+}
+
+} // namespace
+
+bool StreamBuffer::init(GLenum target, size_t size, bool allowPersistent) {
+    shutdown();
+
+    m_target = target;
+    m_segmentSize = size / SEGMENTS;
+    m_size = m_segmentSize * SEGMENTS;
+    m_segment = 0;
+    m_offset = 0;
+
+    glGenBuffers(1, &m_buffer);
+    GLState::bindBuffer(m_target, m_buffer);
+
+    BufferStorageProc bufferStorage = allowPersistent ? loadBufferStorage() : nullptr;
+    if (bufferStorage) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        bufferStorage(m_target, (GLsizeiptr)m_size, nullptr, flags);
+        m_mapped = static_cast<unsigned char*>(glMapBufferRange(m_target, 0, (GLsizeiptr)m_size, flags));
+        if (!m_mapped) {
+            // immutable storage can't be respecified, start over with a plain buffer
+            Common::warn("Persistent mapping failed, streaming with unsynchronized maps");
+            GLState::forgetBuffer(m_buffer);
+            glDeleteBuffers(1, &m_buffer);
+            glGenBuffers(1, &m_buffer);
+            GLState::bindBuffer(m_target, m_buffer);
+        }
+    }
+    if (!m_mapped) {
+        glBufferData(m_target, (GLsizeiptr)m_size, nullptr, GL_STREAM_DRAW);
+    }
+
+    return m_buffer != 0;
+}
+
+void StreamBuffer::shutdown() {
+    for (auto& fence : m_fences) {
+        if (fence) glDeleteSync(fence);
+        fence = nullptr;
+    }
+    if (m_buffer) {
+        if (m_mapped) {
+            GLState::bindBuffer(m_target, m_buffer);
+            glUnmapBuffer(m_target);
+        }
+        GLState::forgetBuffer(m_buffer);
+        glDeleteBuffers(1, &m_buffer);
+    }
+    m_buffer = 0;
+    m_mapped = nullptr;
+    m_size = 0;
+    m_segmentSize = 0;
+}
+
+GLintptr StreamBuffer::write(const void* data, size_t bytes, size_t alignment) {
+    if (!m_buffer || bytes > m_segmentSize) return -1;
+
+    size_t offset = (m_offset + alignment - 1) / alignment * alignment;
+    if (offset + bytes > m_segmentSize) {
+        nextSegment();
+        offset = 0;
+    }
+
+    size_t start = (size_t)m_segment * m_segmentSize + offset;
+    GLState::bindBuffer(m_target, m_buffer);
+    if (m_mapped) {
+        std::memcpy(m_mapped + start, data, bytes);
+    } else {
+        // the fences already guarantee the GPU is done with this range
+        void* ptr = glMapBufferRange(m_target, (GLintptr)start, (GLsizeiptr)bytes,
+            GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+        if (!ptr) return -1;
+        std::memcpy(ptr, data, bytes);
+        glUnmapBuffer(m_target);
+    }
+
+    m_offset = offset + bytes;
+    m_stats.bytes += bytes;
+    return (GLintptr)start;
+}
+
+void StreamBuffer::endFrame() {
+    if (m_offset > 0) nextSegment();
+    m_lastStats = m_stats;
+    m_stats = {};
+}
+
+void StreamBuffer::nextSegment() {
+    m_fences[m_segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_segment = (m_segment + 1) % SEGMENTS;
+    m_offset = 0;
+
+    GLsync& fence = m_fences[m_segment];
+    if (!fence) return;
+
+    auto start = std::chrono::steady_clock::now();
+    GLbitfield flags = 0;
+    while (true) {
+        GLenum result = glClientWaitSync(fence, flags, 1000000); // 1 ms
+        if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED) break;
+        // make sure the fence actually reaches the GPU before waiting longer
+        flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    }
+    m_stats.fenceWaitMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+} // namespace Rendering
+} // namespace Core
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+
+namespace Core {
+namespace Rendering {
+
+// Ring buffer for streaming per-frame vertex data to the GPU.
+//
+// The buffer is split into SEGMENTS equal parts. Each frame starts writing
+// at the next segment (a frame that outgrows one moves on early), and a
+// fence is dropped behind every segment that gets left, so a segment is
+// only written again once the GPU is done drawing from it. Writes never
+// orphan or implicitly synchronise: with ARB_buffer_storage the buffer is
+// mapped once, persistently; without it each write maps its range with
+// GL_MAP_UNSYNCHRONIZED_BIT.
+class StreamBuffer {
+public:
+    static constexpr int SEGMENTS = 3;
+
+    struct Stats {
+        size_t bytes = 0;           // streamed this frame
+        double fenceWaitMs = 0.0;   // spent blocked on segments the GPU still used
+    };
+
+    bool init(GLenum target, size_t size, bool allowPersistent = true);
+    void shutdown();
+
+    // Copies data into the ring and returns its byte offset, aligned to
+    // alignment, or -1 when it is bigger than a segment. Leaves the buffer bound.
+    GLintptr write(const void* data, size_t bytes, size_t alignment);
+
+    // fences what this frame wrote and moves on to the next segment
+    void endFrame();
+
+    GLuint getBuffer() const { return m_buffer; }
+    bool isPersistent() const { return m_mapped != nullptr; }
+    size_t getSize() const { return m_size; }
+    const Stats& getStats() const { return m_lastStats; }
+
+private:
+    void nextSegment();
+
+    GLenum m_target = GL_ARRAY_BUFFER;
+    GLuint m_buffer = 0;
+    size_t m_size = 0;
+    size_t m_segmentSize = 0;
+    unsigned char* m_mapped = nullptr;
+
+    int m_segment = 0;
+    size_t m_offset = 0;    // within the current segment
+    GLsync m_fences[SEGMENTS] = {};
+
+    Stats m_stats;
+    Stats m_lastStats;
+};
+
+} // namespace Rendering
+} // namespace Core
@@ -2,6 +2,7 @@
 #include <common/log.hpp>
 #include <common/common.hpp>
 #include <core/rendering/gl2d.hpp>
+#include <core/rendering/glState.hpp>
 #include <core/rendering/colour.hpp>
 #include <codecvt>
 #include <algorithm>
@@ -196,7 +197,7 @@ Glyph& TextRenderer::loadGlyph(char32_t ch) {
 
     GLuint tex = 0;
     glGenTextures(1, &tex);
-    glBindTexture(GL_TEXTURE_2D, tex);
+    GLState::bindTexture(0, tex);
 
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
@@ -247,49 +248,41 @@ void TextRenderer::renderGlyphString(const std::vector<char32_t>& codepoints, in
                                      float originX, float originY) {
     if (!m_fonts.count(m_currentFont)) return;
 
-    int posX = x;
-    int baselineY = y;
+    // pen position stays fractional so scaled advances don't accumulate rounding
+    float posX = (float)x;
+    float baselineY = (float)y;
 
     for (char32_t cp : codepoints) {
         Glyph& g = loadGlyph(cp);
         if (!g.texture) continue;
 
-        int xpos = posX + static_cast<int>(g.bearingX * scaleX);
-        int ypos = baselineY - static_cast<int>(g.bearingY * scaleY);
+        float xpos = posX + g.bearingX * scaleX;
+        float ypos = baselineY - g.bearingY * scaleY;
 
+        // game pixels; GL2D's projection takes it from here
         float corners[4][2] = {
-            { (float)xpos,                 (float)ypos },
-            { (float)(xpos + g.width),     (float)ypos },
-            { (float)(xpos + g.width),     (float)(ypos + g.height * scaleY) },
-            { (float)xpos,                 (float)(ypos + g.height * scaleY) }
+            { xpos,           ypos },
+            { xpos + g.width, ypos },
+            { xpos + g.width, ypos + g.height * scaleY },
+            { xpos,           ypos + g.height * scaleY }
         };
 
-        for (int i = 0; i < 4; i++) {
-            float vx = corners[i][0] / (float)m_virtualWidth * 2.f - 1.f;
-            float vy = 1.f - (corners[i][1] / (float)m_virtualHeight) * 2.f;
-            corners[i][0] = vx;
-            corners[i][1] = vy;
-        }
-
         auto col = Core::Rendering::getColor();
         float R = col[0];
         float G = col[1];
         float B = col[2];
         float A = col[3];
 
-        std::vector<GL2D::Vertex> verts = {
+        GL2D::PackedVertex verts[4] = {
             { corners[0][0], corners[0][1], 0, 0, R,G,B,A },
             { corners[1][0], corners[1][1], 1, 0, R,G,B,A },
             { corners[2][0], corners[2][1], 1, 1, R,G,B,A },
-
-            { corners[2][0], corners[2][1], 1, 1, R,G,B,A },
-            { corners[3][0], corners[3][1], 0, 1, R,G,B,A },
-            { corners[0][0], corners[0][1], 0, 0, R,G,B,A }
+            { corners[3][0], corners[3][1], 0, 1, R,G,B,A }
         };
 
-        GL2D::drawTriangles(verts, g.texture, m_useSDF);
+        GL2D::drawQuads(verts, 1, g.texture, m_useSDF);
 
-        posX += static_cast<int>(g.advance * scaleX);
+        posX += g.advance * scaleX;
     }
 }
 
@@ -70,9 +70,6 @@ private:
     std::string m_currentFont;
     bool m_initialized;
 
-    int m_virtualWidth  = 1024;
-    int m_virtualHeight = 768;
-
     int m_viewportX = 0;
     int m_viewportY = 0;
     int m_viewportW = 1024;
@@ -0,0 +1,42 @@
+#include "texture.hpp"
+#include "gl2d.hpp"
+#include "glState.hpp"
+
+namespace Core {
+namespace Rendering {
+
+Texture::Texture(GLuint id, int width, int height)
+    : m_id(id), m_width(width), m_height(height) {
+}
+
+Texture::~Texture() {
+    if (m_id != 0) {
+        GL2D::forgetTexture(m_id);
+        GLState::forgetTexture(m_id);
+        glDeleteTextures(1, &m_id);
+        m_id = 0;
+    }
+}
+
+std::shared_ptr<Texture> Texture::create(const unsigned char* rgba, int width, int height, int rowLength) {
+    GLuint id = 0;
+    glGenTextures(1, &id);
+    if (id == 0) return nullptr;
+
+    GLState::bindTexture(0, id);
+
+    if (rowLength > 0) glPixelStorei(GL_UNPACK_ROW_LENGTH, rowLength);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0,
+                 GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+    if (rowLength > 0) glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    return std::make_shared<Texture>(id, width, height);
+}
+
+} // namespace Rendering
+} // namespace Core
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <memory>
+
+namespace Core {
+namespace Rendering {
+
+// Owns one GL texture. Images hold these through shared_ptr so several of
+// them (atlas regions, etc) can point at the same texture.
+class Texture {
+public:
+    Texture(GLuint id, int width, int height);
+    ~Texture();
+
+    Texture(const Texture&) = delete;
+    Texture& operator=(const Texture&) = delete;
+
+    // rowLength is the source stride in pixels when uploading a sub-rectangle of a bigger image
+    static std::shared_ptr<Texture> create(const unsigned char* rgba, int width, int height, int rowLength = 0);
+
+    GLuint getID() const { return m_id; }
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+
+private:
+    GLuint m_id;
+    int m_width;
+    int m_height;
+};
+
+} // namespace Rendering
+} // namespace Core
@@ -0,0 +1,287 @@
+#include "textureCache.hpp"
+#include <common/common.hpp>
+#include <common/log.hpp>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+namespace Core {
+namespace Rendering {
+
+namespace {
+
+constexpr char CACHE_MAGIC[8] = { 'F', 'N', '3', 'T', 'E', 'X', 'C', '\0' };
+constexpr uint32_t CACHE_VERSION = 3;
+constexpr uint32_t FORMAT_RGBA8 = 1;
+constexpr uint64_t BLOB_ALIGN = 4096; // page aligned so uploads read straight from whole pages
+
+uint64_t alignUp(uint64_t value) {
+    return (value + BLOB_ALIGN - 1) & ~(BLOB_ALIGN - 1);
+}
+
+void padTo(std::ostream& out, uint64_t pos) {
+    static const char zeros[BLOB_ALIGN] = {};
+    uint64_t cur = static_cast<uint64_t>(out.tellp());
+    while (cur < pos) {
+        uint64_t n = std::min<uint64_t>(pos - cur, BLOB_ALIGN);
+        out.write(zeros, static_cast<std::streamsize>(n));
+        cur += n;
+    }
+}
+
+bool copyRange(std::istream& in, uint64_t offset, uint64_t size, std::ostream& out) {
+    std::vector<char> buf(1 << 20);
+    in.seekg(static_cast<std::streamoff>(offset));
+    while (size > 0 && in) {
+        uint64_t n = std::min<uint64_t>(size, buf.size());
+        in.read(buf.data(), static_cast<std::streamsize>(n));
+        out.write(buf.data(), in.gcount());
+        size -= static_cast<uint64_t>(in.gcount());
+    }
+    return size == 0 && out.good();
+}
+
+} // namespace
+
+uint64_t TextureCache::makeKey(const std::string& name) {
+    return static_cast<uint64_t>(Common::hashString(name));
+}
+
+bool TextureCache::open(const std::string& path) {
+    close();
+    m_path = path;
+
+    if (!m_file.open(path)) return false;
+
+    const unsigned char* base = m_file.data();
+    const uint64_t size = m_file.size();
+
+    Header header;
+    if (size < sizeof(Header)) { m_file.close(); return false; }
+    std::memcpy(&header, base, sizeof(Header));
+
+    if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+        header.version != CACHE_VERSION ||
+        header.indexOffset > size ||
+        (size - header.indexOffset) / sizeof(Entry) < header.entryCount) {
+        Common::warn("Texture cache is invalid or from an older version, rebuilding: " + path);
+        m_file.close();
+        return false;
+    }
+
+    m_index.resize(header.entryCount);
+    if (header.entryCount > 0) {
+        std::memcpy(m_index.data(), base + header.indexOffset, header.entryCount * sizeof(Entry));
+    }
+
+    for (const auto& e : m_index) {
+        if (e.offset > size || e.size > size - e.offset) {
+            Common::warn("Texture cache has out of range entries, rebuilding: " + path);
+            m_index.clear();
+            m_file.close();
+            return false;
+        }
+    }
+
+    std::sort(m_index.begin(), m_index.end(), [](const Entry& a, const Entry& b) { return a.key < b.key; });
+    m_used.assign(m_index.size(), false);
+    m_fileSize = size;
+    m_valid = true;
+    return true;
+}
+
+void TextureCache::close() {
+    m_file.close();
+    if (m_staging.is_open()) m_staging.close();
+
+    m_valid = false;
+    m_fileSize = 0;
+    m_index.clear();
+    m_used.clear();
+    m_staged.clear();
+    m_stagingSize = 0;
+    m_hits = 0;
+}
+
+const TextureCache::Entry* TextureCache::lookup(uint64_t key, int64_t sourceTime, uint64_t sourceSize) {
+    if (!m_valid || !m_file.isOpen()) return nullptr;
+
+    auto it = std::lower_bound(m_index.begin(), m_index.end(), key,
+        [](const Entry& e, uint64_t k) { return e.key < k; });
+    if (it == m_index.end() || it->key != key) return nullptr;
+
+    const Entry& e = *it;
+    if (e.sourceTime != sourceTime || e.sourceSize != sourceSize || e.format != FORMAT_RGBA8 ||
+        (uint64_t)e.width * e.height * 4 != e.size ||
+        e.trimWidth == 0 || e.trimX + e.trimWidth > e.width || e.trimY + e.trimHeight > e.height) {
+        return nullptr; // stale, gets restaged by the caller
+    }
+
+    m_used[it - m_index.begin()] = true;
+    return &e;
+}
+
+const unsigned char* TextureCache::find(uint64_t key, int64_t sourceTime, uint64_t sourceSize, const Entry** entry) {
+    const Entry* e = lookup(key, sourceTime, sourceSize);
+    if (!e) return nullptr;
+
+    ++m_hits;
+    if (entry) *entry = e;
+    return m_file.data() + e->offset;
+}
+
+const TextureCache::Entry* TextureCache::peek(uint64_t key, int64_t sourceTime, uint64_t sourceSize) {
+    return lookup(key, sourceTime, sourceSize);
+}
+
+void TextureCache::stage(uint64_t key, int64_t sourceTime, uint64_t sourceSize, const PixelData& data) {
+    if (m_path.empty()) return;
+
+    if (!m_staging.is_open()) {
+        m_staging.open(m_path + ".staging", std::ios::binary | std::ios::trunc);
+        m_stagingSize = 0;
+        if (!m_staging) {
+            Common::warn("Unable to open texture cache staging file: " + m_path + ".staging");
+            return;
+        }
+    }
+
+    Entry e{};
+    e.key = key;
+    e.sourceTime = sourceTime;
+    e.sourceSize = sourceSize;
+    e.width = (uint32_t)data.width;
+    e.height = (uint32_t)data.height;
+    e.format = FORMAT_RGBA8;
+    e.offset = m_stagingSize;
+    e.size = data.pixels.size();
+    e.contentHash = data.hash ? data.hash : PixelData::computeHash(data.pixels.data(), data.width, data.height);
+    TrimRect trim = data.trim.width > 0 ? data.trim : TrimRect::find(data.pixels.data(), data.width, data.height);
+    e.trimX = (uint16_t)trim.x;
+    e.trimY = (uint16_t)trim.y;
+    e.trimWidth = (uint16_t)trim.width;
+    e.trimHeight = (uint16_t)trim.height;
+
+    m_staging.write(reinterpret_cast<const char*>(data.pixels.data()), static_cast<std::streamsize>(e.size));
+    if (!m_staging) return;
+
+    m_stagingSize += e.size;
+    m_staged.push_back(e);
+}
+
+bool TextureCache::writeIndex(std::fstream& out, std::vector<Entry>& entries, uint64_t indexOffset) {
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.key < b.key; });
+    entries.erase(std::unique(entries.begin(), entries.end(),
+        [](const Entry& a, const Entry& b) { return a.key == b.key; }), entries.end());
+
+    padTo(out, indexOffset);
+    out.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(Entry)));
+
+    Header header{};
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.entryCount = (uint32_t)entries.size();
+    header.indexOffset = indexOffset;
+
+    // header goes last so a crash mid-write leaves the old index in charge
+    out.flush();
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    out.flush();
+    return out.good();
+}
+
+bool TextureCache::append(const std::vector<Entry>& live) {
+    std::fstream out(m_path, std::ios::in | std::ios::out | std::ios::binary);
+    std::ifstream staging(m_path + ".staging", std::ios::binary);
+    if (!out || !staging) return false;
+
+    out.seekp(0, std::ios::end);
+    std::vector<Entry> entries = live;
+    for (Entry e : m_staged) {
+        uint64_t pos = alignUp(static_cast<uint64_t>(out.tellp()));
+        padTo(out, pos);
+        if (!copyRange(staging, e.offset, e.size, out)) return false;
+        e.offset = pos;
+        entries.push_back(e);
+    }
+
+    return writeIndex(out, entries, static_cast<uint64_t>(out.tellp()));
+}
+
+bool TextureCache::rewrite(const std::vector<Entry>& live) {
+    std::string tmpPath = m_path + ".tmp";
+    {
+        std::fstream out(tmpPath, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+
+        std::vector<Entry> entries;
+        entries.reserve(live.size() + m_staged.size());
+
+        auto copyFrom = [&](std::istream& in, Entry e) {
+            uint64_t pos = alignUp(std::max<uint64_t>(static_cast<uint64_t>(out.tellp()), sizeof(Header)));
+            padTo(out, pos);
+            if (!copyRange(in, e.offset, e.size, out)) return false;
+            e.offset = pos;
+            entries.push_back(e);
+            return true;
+        };
+
+        if (!live.empty()) {
+            std::ifstream old(m_path, std::ios::binary);
+            for (const auto& e : live) {
+                if (!copyFrom(old, e)) return false;
+            }
+        }
+        if (!m_staged.empty()) {
+            std::ifstream staging(m_path + ".staging", std::ios::binary);
+            for (const auto& e : m_staged) {
+                if (!copyFrom(staging, e)) return false;
+            }
+        }
+
+        uint64_t indexOffset = std::max<uint64_t>(static_cast<uint64_t>(out.tellp()), sizeof(Header));
+        if (!writeIndex(out, entries, indexOffset)) return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, m_path, ec);
+    return !ec;
+}
+
+bool TextureCache::commit() {
+    // the mapping has to go before the file can be appended to or replaced
+    m_file.close();
+    if (m_staging.is_open()) m_staging.close();
+
+    std::vector<Entry> live;
+    uint64_t liveBytes = 0;
+    for (size_t i = 0; i < m_index.size(); ++i) {
+        if (!m_used[i]) continue;
+        live.push_back(m_index[i]);
+        liveBytes += m_index[i].size;
+    }
+
+    bool ok = true;
+    bool dropped = live.size() != m_index.size();
+    if (!m_staged.empty() || dropped || !m_valid) {
+        uint64_t stagedBytes = 0;
+        for (const auto& e : m_staged) stagedBytes += e.size;
+
+        // compact once more than half of the file would be dead weight
+        uint64_t deadBytes = m_fileSize > liveBytes ? m_fileSize - liveBytes : 0;
+        bool compact = !m_valid || deadBytes > liveBytes + stagedBytes;
+
+        ok = compact ? rewrite(live) : append(live);
+        if (!ok) Common::warn("Unable to update texture cache: " + m_path);
+    }
+
+    std::error_code ec;
+    std::filesystem::remove(m_path + ".staging", ec);
+
+    close();
+    return ok;
+}
+
+} // namespace Rendering
+} // namespace Core
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <common/mappedFile.hpp>
+#include <core/rendering/image.hpp>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace Core {
+namespace Rendering {
+
+// On-disk cache of already decoded RGBA8 texel data.
+//
+// Layout: a small header, page aligned texel blobs, then a sorted index
+// at the end. The file is mmapped on open so hits can be uploaded
+// straight from the mapping. Misses are staged to a side file while
+// loading and merged in by commit(), which only appends what changed
+// (or compacts when too much of the file is stale).
+class TextureCache {
+public:
+    struct Entry {
+        uint64_t key;
+        int64_t sourceTime;
+        uint64_t sourceSize;
+        uint32_t width;
+        uint32_t height;
+        uint32_t format;
+        uint32_t reserved;
+        uint64_t offset;
+        uint64_t size;
+        uint64_t contentHash; // PixelData::hash, lets identical images share a texture without reading them
+        uint16_t trimX;       // PixelData::trim, so hits don't have to rescan the alpha
+        uint16_t trimY;
+        uint16_t trimWidth;
+        uint16_t trimHeight;
+
+        TrimRect trim() const { return { trimX, trimY, trimWidth, trimHeight }; }
+    };
+
+    static uint64_t makeKey(const std::string& name);
+
+    bool open(const std::string& path);
+    void close();
+
+    // nullptr on a miss, or when the source file changed since it was cached.
+    // The pointers stay valid until close()/commit(). Entries that are never
+    // found or peeked before commit() are treated as dead and dropped.
+    const unsigned char* find(uint64_t key, int64_t sourceTime, uint64_t sourceSize, const Entry** entry = nullptr);
+    // like find() but only returns the entry (size, hash, trim) and doesn't count as a hit
+    const Entry* peek(uint64_t key, int64_t sourceTime, uint64_t sourceSize);
+
+    void stage(uint64_t key, int64_t sourceTime, uint64_t sourceSize, const PixelData& data);
+    bool commit();
+
+    size_t getHits() const { return m_hits; }
+    size_t getMisses() const { return m_staged.size(); }
+
+private:
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t entryCount;
+        uint64_t indexOffset;
+    };
+
+    const Entry* lookup(uint64_t key, int64_t sourceTime, uint64_t sourceSize);
+    bool rewrite(const std::vector<Entry>& live);
+    bool append(const std::vector<Entry>& live);
+    bool writeIndex(std::fstream& out, std::vector<Entry>& entries, uint64_t indexOffset);
+
+    std::string m_path;
+    Common::MappedFile m_file;
+    bool m_valid = false;
+    uint64_t m_fileSize = 0;
+
+    std::vector<Entry> m_index;
+    std::vector<bool> m_used;
+    size_t m_hits = 0;
+
+    std::vector<Entry> m_staged;
+    std::ofstream m_staging;
+    uint64_t m_stagingSize = 0;
+};
+
+} // namespace Rendering
+} // namespace Core
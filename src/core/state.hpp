@@ -13,6 +13,9 @@ public:
 
     virtual ~State() = default;
 
+    // Called on the next state by Game::prefetchState(), while the current one is still
+    // running. Kick off background loads here so enter() only waits on what's left.
+    virtual void prefetch([[maybe_unused]] Game& game) {}
     virtual void enter([[maybe_unused]] Game& game) {}
     virtual void handleEvents([[maybe_unused]] Game& game, [[maybe_unused]] SDL_Event& event) = 0;
     virtual void update([[maybe_unused]] Game& game, [[maybe_unused]] float dt) = 0;
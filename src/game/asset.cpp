@@ -1,8 +1,26 @@
 #include "asset.hpp"
 
+#include "residency.hpp"
+
 #include <core/game.hpp>
+#include <core/debug.hpp>
+#include <core/helpers/spscQueue.hpp>
+#include <core/helpers/workerPool.hpp>
+#include <common/log.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <imgui.h>
 
 #define George() entry.path().stem().string().c_str()
 #define GeorgeButFuckedUp() entry.path().filename().string().c_str()
@@ -26,6 +44,16 @@ Asset::~Asset() {
     unload();
 }
 
+void Asset::render(int x, int y, int width, int height, float rotation, int originX, int originY) {
+    Assets::Residency::touch(this);
+    Image::render(x, y, width, height, rotation, originX, originY);
+}
+
+void Asset::submit(uint8_t layer, uint16_t depth, int x, int y, int width, int height, float rotation) {
+    Assets::Residency::touch(this);
+    Image::submit(layer, depth, x, y, width, height, rotation);
+}
+
 Animation::Animation()
     : currentFrame(0), currentSubframe(0.0f) {
 }
@@ -41,13 +69,131 @@ void Animation::add(Asset* asset) {
     frames.push_back(asset);
 }
 
+namespace {
+
+// Sounds are only registered at startup; they load on first play or ahead
+// of time through prefetchSounds(). Workers hand finished loads back here,
+// the sound table itself is only ever touched on the main thread.
+struct SoundSource {
+    std::string path;
+    const Common::Pack::Entry* entry = nullptr; // set when it comes from the pack
+    bool stream = false;
+};
+
+struct Sound {
+    std::string name;
+    SoundSource source;
+    bool registered = false;
+    bool loaded = false;    // a load was attempted, audio may still be null
+    MIX_Audio* audio = nullptr;
+};
+
+// Voice bookkeeping lives on the main thread; the MIX_Track itself is only
+// ever touched by the audio worker, through commands.
+struct Voice {
+    MIX_Track* track = nullptr;
+    Assets::SoundId sound = Assets::INVALID_SOUND;
+    int priority = 0;
+    bool looping = false;
+    uint16_t generation = 0;
+    uint64_t started = 0;
+    // a streamed play left its own SDL_IOStream on the track, closed once
+    // the stopped event for that generation comes back
+    bool streamOpen = false;
+    uint16_t streamGeneration = 0;
+};
+
+// Main thread -> audio worker. Every command names the voice generation it
+// was issued for, so the worker can tell a stale stop from the current play.
+struct AudioCommand {
+    enum class Type : uint8_t {
+        Play,
+        Stop,
+        Gain,
+        Pan,
+        Close,  // drops the track's input, closing a stream it was reading
+        Sweep,  // reports every track that isn't playing through stoppedVoices
+    };
+
+    Type type;
+    uint16_t slot;
+    uint16_t generation;
+    MIX_Audio* audio;
+    int loops;
+    int fadeMs;     // fade in for Play, fade out for Stop
+    float value;    // gain, or pan from -1 (left) to 1 (right)
+    SDL_IOStream* io = nullptr; // Play of a streamed sound, the track takes ownership
+};
+
+// Posted by the track-stopped callback, drained by the main thread. The
+// mixer only runs the callback under its own lock (also when MIX_StopTrack
+// stops a track on the worker), and the worker takes that lock too when it
+// posts failed plays and sweeps, so there is only ever one producer.
+struct VoiceStopped {
+    uint16_t slot;
+    uint16_t generation;
+};
+
+// function local so states can intern ids during static initialisation
+struct SoundTable {
+    std::vector<Sound> sounds;
+    std::unordered_map<std::string, Assets::SoundId> ids;
+};
+
+SoundTable& soundTable() {
+    static SoundTable table;
+    return table;
+}
+
+Voice voices[Assets::MAX_VOICES];
+uint64_t voiceCounter = 0;
+Assets::AudioStats audioStats;
+SDL_PropertiesID playOptions = 0;
+Core::Helpers::SpscQueue<VoiceStopped, 256> stoppedVoices;
+std::atomic<bool> voicesNeedSweep{ false };
+
+Core::Helpers::SpscQueue<AudioCommand, 1024> audioCommands;
+std::atomic<uint32_t> audioSignal{ 0 };
+std::atomic<bool> audioWorkerRunning{ false };
+std::thread audioWorker;
+// the generation each track is currently playing for, written by the worker
+std::atomic<uint16_t> playingGeneration[Assets::MAX_VOICES];
+
+// what the device mixer actually runs at, predecoded sounds get converted to it
+SDL_AudioSpec deviceSpec{};
+bool haveDeviceSpec = false;
+
+std::mutex soundMutex;
+std::condition_variable soundLoaded;
+std::unordered_set<Assets::SoundId> soundsLoading;
+std::vector<std::pair<Assets::SoundId, MIX_Audio*>> soundsDone;
+
+void collectSounds();
+MIX_Audio* loadSound(const SoundSource& source);
+SDL_IOStream* openStream(const SoundSource& source);
+MIX_Audio* decodeSound(const SoundSource& source, MIX_Mixer* target, const SDL_AudioSpec* convertTo);
+bool shouldStream(const SoundSource& source);
+Sound* findSound(Assets::SoundId id);
+Voice* findVoice(Assets::VoiceHandle handle);
+void releaseVoice(Voice& voice);
+Voice* acquireVoice(int priority);
+void SDLCALL onTrackStopped(void* userdata, MIX_Track* track);
+void drainStoppedVoices();
+void sendCommand(const AudioCommand& command);
+void audioWorkerLoop();
+void drawAudioPanel();
+
+} // namespace
+
 namespace Assets {
 MIX_Mixer* mixer;
-Asset* assetList[1151];
+Asset* assetList[MAX_ASSETS];
+Common::Pack pack;
 
-std::unordered_map<std::string, MIX_Audio*> soundMap;
-std::unordered_map<std::string, MIX_Track*> audioTracks;
-std::unordered_map<std::string, MIX_Track*> loopingTracks;
+bool streamAudio = true;
+float streamMinSeconds = 10.0f;
+size_t streamMinBytes = 4 * 1024 * 1024;
+bool normalizeAudio = true;
 
 void initAudio() {
     if (!MIX_Init()) {
@@ -58,51 +204,163 @@ void initAudio() {
     mixer = MIX_CreateMixerDevice(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, NULL);
     if (!mixer) {
         std::cerr << "Failed to create mixer: " << SDL_GetError() << "\n";
+        return;
+    }
+
+    haveDeviceSpec = MIX_GetMixerFormat(mixer, &deviceSpec);
+    if (haveDeviceSpec) {
+        char buf[128];
+        std::snprintf(buf, sizeof(buf), "Audio device: %d Hz, %d channel(s), format 0x%04x",
+            deviceSpec.freq, deviceSpec.channels, (unsigned)deviceSpec.format);
+        Common::info(buf);
     }
+
+    for (auto& voice : voices) {
+        voice.track = MIX_CreateTrack(mixer);
+        if (!voice.track) {
+            std::cerr << "Failed to create track: " << SDL_GetError() << "\n";
+            continue;
+        }
+        MIX_SetTrackStoppedCallback(voice.track, onTrackStopped, reinterpret_cast<void*>((intptr_t)(&voice - voices)));
+    }
+    playOptions = SDL_CreateProperties();
+
+    audioWorkerRunning = true;
+    audioWorker = std::thread(audioWorkerLoop);
+    Core::Debug::addPanel("Audio", drawAudioPanel);
+}
+
+SoundId soundId(const std::string& name) {
+    auto& table = soundTable();
+    auto it = table.ids.find(name);
+    if (it != table.ids.end()) return it->second;
+
+    SoundId id = (SoundId)table.sounds.size();
+    table.sounds.push_back({});
+    table.sounds.back().name = name;
+    table.ids.emplace(name, id);
+    return id;
 }
 
 void loadAllAssets() {
+    // one mmapped archive instead of ~1150 loose files when it's there
+    std::string packPath = Core::Game::getExecutableDirectory() + "assets.pack";
+    if (std::filesystem::exists(packPath)) {
+        if (pack.open(packPath)) Common::info("Loading assets from " + packPath);
+        else Common::warn("Invalid asset pack, falling back to loose files: " + packPath);
+    }
+
     std::string assetDir = Core::Game::getExecutableDirectory() + "assets/images/";
+    Residency::init(assetDir);
 
-    for (const auto& entry : std::filesystem::directory_iterator(assetDir)) {
-        if (entry.is_regular_file()) {
-            int index = std::stoi(entry.path().stem().string());
-            assetList[index] = new Asset(entry.path().string());
-            //std::cout << "Loaded asset " << index << ": " << entry.path().string() << "\n";
+    assetDir = Core::Game::getExecutableDirectory() + "assets/audio/";
+    if (!mixer) return;
+
+    auto registerSound = [](const std::string& name, SoundSource source) {
+        Sound& sound = soundTable().sounds[soundId(name)];
+        sound.source = std::move(source);
+        sound.registered = true;
+    };
+
+    if (pack.isOpen()) {
+        for (const auto* entry = pack.begin(Common::Pack::Type::Audio); entry != pack.end(Common::Pack::Type::Audio); ++entry) {
+            std::filesystem::path filename(pack.name(*entry));
+            registerSound(filename.stem().string(), { filename.string(), entry });
+        }
+    } else {
+        for (const auto& entry : std::filesystem::directory_iterator(assetDir)) {
+            Do It Jiggle Girl
+                std::string filename = GeorgeButFuckedUp();
+                registerSound(George(), { AwesomeSauce(), nullptr });
+            Answer Me Princess
         }
     }
 
-    assetDir = Core::Game::getExecutableDirectory() + "assets/audio/";
+    size_t registered = 0;
+    size_t streamed = 0;
+    for (auto& sound : soundTable().sounds) {
+        if (!sound.registered) continue;
+        ++registered;
+        sound.source.stream = shouldStream(sound.source);
+        if (sound.source.stream) ++streamed;
+    }
+    Common::info("Audio: " + std::to_string(streamed) + " of " + std::to_string(registered) +
+        " sounds stream from disk, the rest are predecoded on first use");
+}
+
+void prefetchSounds(const std::vector<SoundId>& ids) {
     if (!mixer) return;
 
-    for (const auto& entry : std::filesystem::directory_iterator(assetDir)) {
-        Do It Jiggle Girl
-            std::string filename = GeorgeButFuckedUp();
+    for (SoundId id : ids) {
+        Sound* sound = findSound(id);
+        // streamed sounds have nothing to preload, every voice opens its own stream
+        if (!sound || !sound->registered || sound->loaded || sound->source.stream) continue;
 
-            MIX_Audio* audio = MIX_LoadAudio(mixer, AwesomeSauce(), true);
-            if (!audio) {
-                std::cerr << "Failed to load audio: " << filename << " Error: " << SDL_GetError() << "\n";
-            } else {
-                soundMap[George()] = audio;
-            }
-        Answer Me Princess
+        {
+            std::lock_guard<std::mutex> lock(soundMutex);
+            if (!soundsLoading.insert(id).second) continue;
+        }
+
+        Core::Helpers::WorkerPool::get().submit([id, source = sound->source] {
+            MIX_Audio* audio = loadSound(source);
+
+            std::lock_guard<std::mutex> lock(soundMutex);
+            soundsLoading.erase(id);
+            soundsDone.emplace_back(id, audio);
+            soundLoaded.notify_all();
+        });
     }
 }
 
 void unloadAllAssets() {
-    for (int i = 0; i < 1151; ++i) {
+    Residency::shutdown();
+    collectSounds();
+    for (int i = 0; i < MAX_ASSETS; ++i) {
         if (assetList[i]) {
             delete assetList[i];
             assetList[i] = nullptr;
         }
     }
 
-    for (auto& pair : soundMap) {
-        if (pair.second) {
-            MIX_DestroyAudio(pair.second);
+    if (audioWorker.joinable()) {
+        audioWorkerRunning = false;
+        audioSignal.fetch_add(1, std::memory_order_release);
+        audioSignal.notify_one();
+        audioWorker.join();
+    }
+
+    for (auto& voice : voices) {
+        if (voice.track) {
+            MIX_SetTrackStoppedCallback(voice.track, nullptr, nullptr);
+            MIX_StopTrack(voice.track, 0);
+            MIX_DestroyTrack(voice.track);
+        }
+        voice.track = nullptr;
+        voice.sound = INVALID_SOUND;
+        voice.looping = false;
+        voice.streamOpen = false;
+    }
+    VoiceStopped event;
+    while (stoppedVoices.tryPop(event)) {}
+    audioStats.activeVoices = 0;
+    audioStats.queueDepth = 0;
+    if (playOptions) {
+        SDL_DestroyProperties(playOptions);
+        playOptions = 0;
+    }
+    Core::Debug::removePanel("Audio");
+
+    // names (and so ids) stay interned, only the audio goes
+    for (auto& sound : soundTable().sounds) {
+        if (sound.audio) {
+            MIX_DestroyAudio(sound.audio);
         }
+        sound.audio = nullptr;
+        sound.loaded = false;
+        sound.registered = false;
+        sound.source = {};
     }
-    soundMap.clear();
+    pack.close();
 
     if (mixer) {
         MIX_DestroyMixer(mixer);
@@ -111,93 +369,516 @@ void unloadAllAssets() {
     MIX_Quit();
 }
 
-void playSound(const std::string& name, int loops = 0) {
-    auto itOld = audioTracks.find(name);
-    if (itOld != audioTracks.end()) {
-        if (itOld->second) {
-            MIX_StopTrack(itOld->second, 0);
-            MIX_DestroyTrack(itOld->second);
+VoiceHandle play(SoundId id, int loops, int priority, int fadeInMs) {
+    Sound* sound = findSound(id);
+    if (!sound || !mixer) return {};
+
+    SDL_IOStream* stream = nullptr;
+    if (sound->registered && sound->source.stream) {
+        stream = openStream(sound->source);
+        if (!stream) {
+            std::cerr << "Failed to open audio stream: " << sound->source.path << " Error: " << SDL_GetError() << "\n";
+            return {};
+        }
+    } else if (!sound->loaded) {
+        // still loading in the background, or nobody prefetched it
+        {
+            std::unique_lock<std::mutex> lock(soundMutex);
+            soundLoaded.wait(lock, [id] { return !soundsLoading.count(id); });
         }
-        audioTracks.erase(itOld);
+        collectSounds();
     }
 
-    auto loopOld = loopingTracks.find(name);
-    if (loopOld != loopingTracks.end()) {
-        if (loopOld->second) {
-            MIX_StopTrack(loopOld->second, 0);
-            MIX_DestroyTrack(loopOld->second);
+    if (!stream && !sound->loaded) {
+        if (!sound->registered) {
+            std::cerr << "Sound not found: " << sound->name << "\n";
+            return {};
         }
-        loopingTracks.erase(loopOld);
+        sound->audio = loadSound(sound->source);
+        sound->loaded = true;
     }
 
-    auto itSound = soundMap.find(name);
-    if (itSound == soundMap.end()) {
-        std::cerr << "Sound not found: " << name << "\n";
-        return;
+    if (!stream && !sound->audio) {
+        std::cerr << "Audio is null for sound: " << sound->name << "\n";
+        return {};
     }
 
-    MIX_Audio* audio = itSound->second;
-    if (!audio) {
-        std::cerr << "Audio is null for sound: " << name << "\n";
-        return;
+    Voice* voice = acquireVoice(priority);
+    if (!voice) {
+        if (stream) SDL_CloseIO(stream);
+        ++audioStats.dropped;
+        return {};
     }
 
-    MIX_Track* track = MIX_CreateTrack(mixer);
-    if (!track) {
-        std::cerr << "Failed to create track for audio: " << name << "\n";
-        return;
+    uint16_t slot = (uint16_t)(voice - voices);
+    AudioCommand command{ AudioCommand::Type::Play, slot, voice->generation, sound->audio, loops, fadeInMs, 0.0f };
+    command.io = stream;
+    sendCommand(command);
+
+    // a new play replaces the track's input, which closes any stream left on it
+    voice->streamOpen = stream != nullptr;
+    voice->streamGeneration = voice->generation;
+
+    voice->sound = id;
+    voice->priority = priority;
+    voice->looping = loops < 0;
+    voice->started = ++voiceCounter;
+    ++audioStats.activeVoices;
+    audioStats.peakVoices = std::max(audioStats.peakVoices, audioStats.activeVoices);
+    return { slot, voice->generation };
+}
+
+void stop(VoiceHandle handle, int fadeOutMs) {
+    Voice* voice = findVoice(handle);
+    if (!voice) return;
+    sendCommand({ AudioCommand::Type::Stop, handle.slot, handle.generation, nullptr, 0, fadeOutMs, 0.0f });
+    releaseVoice(*voice);
+}
+
+void stopAll(SoundId id, int fadeOutMs) {
+    for (auto& voice : voices) {
+        if (voice.sound != id) continue;
+        stop({ (uint16_t)(&voice - voices), voice.generation }, fadeOutMs);
     }
+}
+
+void setVolume(VoiceHandle handle, float gain) {
+    if (!findVoice(handle)) return;
+    sendCommand({ AudioCommand::Type::Gain, handle.slot, handle.generation, nullptr, 0, 0, gain });
+}
 
-    MIX_SetTrackAudio(track, audio);
+void setPan(VoiceHandle handle, float pan) {
+    if (!findVoice(handle)) return;
+    sendCommand({ AudioCommand::Type::Pan, handle.slot, handle.generation, nullptr, 0, 0, std::clamp(pan, -1.0f, 1.0f) });
+}
 
-    int playLoops = (loops < 0) ? -1 : loops;
+// the voice is released as soon as its stopped event comes back
+bool isPlaying(VoiceHandle handle) {
+    return findVoice(handle) != nullptr;
+}
 
-    if (!MIX_PlayTrack(track, playLoops)) {
-        std::cerr << "Failed to play audio track: " << name << " Error: " << SDL_GetError() << "\n";
-        MIX_DestroyTrack(track);
-        return;
+const AudioStats& getAudioStats() {
+    return audioStats;
+}
+
+void playSound(const std::string& name, int loops = 0) {
+    SoundId id = soundId(name);
+    stopAll(id);
+    play(id, loops, loops < 0 ? PRIORITY_MUSIC : PRIORITY_SFX);
+}
+
+void stopAudio(const std::string& name) {
+    stopAll(soundId(name));
+}
+
+void updateAudio() {
+    collectSounds();
+    drainStoppedVoices();
+}
+
+int benchmarkMixer(int voiceCount, float seconds) {
+    SDL_AudioSpec spec = haveDeviceSpec ? deviceSpec : SDL_AudioSpec{ SDL_AUDIO_F32, 2, 48000 };
+
+    // predecoded sounds only, streamed ones would mostly measure decoding
+    std::vector<const SoundSource*> sources;
+    for (const auto& sound : soundTable().sounds) {
+        if (sound.registered && !sound.source.stream) sources.push_back(&sound.source);
+    }
+    if (sources.empty() || voiceCount <= 0) {
+        Common::error("Mixer benchmark: no sounds to play");
+        return 1;
     }
 
-    if (loops < 0) {
-        loopingTracks[name] = track;
+    // one device callback's worth of frames per MIX_Generate
+    constexpr int BLOCK_FRAMES = 1024;
+    int blocks = std::max(1, (int)(seconds * spec.freq / BLOCK_FRAMES));
+    double audioMs = blocks * BLOCK_FRAMES * 1000.0 / spec.freq;
+
+    auto run = [&](const char* label, bool convert) -> double {
+        MIX_Mixer* offline = MIX_CreateMixer(&spec);
+        if (!offline) {
+            Common::error(std::string("Mixer benchmark: failed to create mixer: ") + SDL_GetError());
+            return -1.0;
+        }
+
+        SDL_PropertiesID options = SDL_CreateProperties();
+        SDL_SetNumberProperty(options, MIX_PROP_PLAY_LOOPS_NUMBER, -1);
+
+        std::unordered_map<const SoundSource*, MIX_Audio*> decoded;
+        std::vector<MIX_Track*> tracks;
+        for (int i = 0; i < voiceCount; ++i) {
+            const SoundSource* source = sources[i % sources.size()];
+            auto it = decoded.find(source);
+            if (it == decoded.end()) it = decoded.emplace(source, decodeSound(*source, offline, convert ? &spec : nullptr)).first;
+            if (!it->second) continue;
+
+            MIX_Track* track = MIX_CreateTrack(offline);
+            if (!track) continue;
+            MIX_SetTrackAudio(track, it->second);
+            if (!MIX_PlayTrack(track, options)) {
+                std::cerr << "Failed to play audio track: " << SDL_GetError() << "\n";
+                MIX_DestroyTrack(track);
+                continue;
+            }
+            tracks.push_back(track);
+        }
+
+        // an idle mixer would still come back with a (meaningless) timing
+        double ms = -1.0;
+        if (tracks.empty()) {
+            Common::error(std::string("Mixer benchmark (") + label + "): no voices started");
+        } else {
+            std::vector<unsigned char> buffer((size_t)BLOCK_FRAMES * SDL_AUDIO_FRAMESIZE(spec));
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < blocks; ++i) {
+                MIX_Generate(offline, buffer.data(), (int)buffer.size());
+            }
+            ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            char buf[192];
+            std::snprintf(buf, sizeof(buf), "Mixer benchmark (%s): %zu voices, %.0f ms of audio mixed in %.2f ms (%.2f%% of realtime, %.1f us per %d frame callback)",
+                label, tracks.size(), audioMs, ms, ms * 100.0 / audioMs, ms * 1000.0 / blocks, BLOCK_FRAMES);
+            Common::info(buf);
+        }
+
+        for (auto* track : tracks) MIX_DestroyTrack(track);
+        for (auto& [source, audio] : decoded) {
+            if (audio) MIX_DestroyAudio(audio);
+        }
+        SDL_DestroyProperties(options);
+        MIX_DestroyMixer(offline);
+        return ms;
+    };
+
+    double native = run("file format", false);
+    double converted = run("device format", true);
+    if (native < 0.0 || converted < 0.0) return 1;
+
+    char buf[128];
+    std::snprintf(buf, sizeof(buf), "Mixer benchmark: converting at load time mixes %.2fx as fast", native / std::max(converted, 0.001));
+    Common::info(buf);
+    return 0;
+}
+
+} // namespace Assets
+
+namespace {
+
+void collectSounds() {
+    std::lock_guard<std::mutex> lock(soundMutex);
+    for (auto& [id, audio] : soundsDone) {
+        Sound& sound = soundTable().sounds[id];
+        sound.audio = audio;
+        sound.loaded = true;
     }
+    soundsDone.clear();
+}
 
-    audioTracks[name] = track;
+Sound* findSound(Assets::SoundId id) {
+    auto& sounds = soundTable().sounds;
+    if (id < 0 || id >= (Assets::SoundId)sounds.size()) return nullptr;
+    return &sounds[id];
 }
 
-void stopAudio(const std::string& name) {
-    auto loopIt = loopingTracks.find(name);
-    if (loopIt != loopingTracks.end()) {
-        loopingTracks.erase(loopIt);
+Voice* findVoice(Assets::VoiceHandle handle) {
+    if (handle.slot >= Assets::MAX_VOICES) return nullptr;
+    Voice& voice = voices[handle.slot];
+    if (voice.sound == Assets::INVALID_SOUND || voice.generation != handle.generation) return nullptr;
+    return &voice;
+}
+
+// old handles to the voice go stale
+void releaseVoice(Voice& voice) {
+    if (voice.sound == Assets::INVALID_SOUND) return;
+    voice.sound = Assets::INVALID_SOUND;
+    voice.looping = false;
+    ++voice.generation;
+    --audioStats.activeVoices;
+}
+
+void SDLCALL onTrackStopped(void* userdata, MIX_Track* /* track */) {
+    uint16_t slot = (uint16_t)reinterpret_cast<intptr_t>(userdata);
+    VoiceStopped event{ slot, playingGeneration[slot].load(std::memory_order_relaxed) };
+    if (!stoppedVoices.tryPush(event)) voicesNeedSweep.store(true, std::memory_order_relaxed);
+}
+
+// Stale events (the voice was stopped or stolen and replayed since) don't
+// match the voice's generation any more and are dropped.
+void drainStoppedVoices() {
+    VoiceStopped event;
+    while (stoppedVoices.tryPop(event)) {
+        Voice& voice = voices[event.slot];
+        if (voice.sound != Assets::INVALID_SOUND && voice.generation == event.generation) {
+            releaseVoice(voice);
+        }
+        // stopped for good (a fade out included), let go of the file
+        if (voice.streamOpen && voice.streamGeneration == event.generation) {
+            sendCommand({ AudioCommand::Type::Close, event.slot, event.generation, nullptr, 0, 0, 0.0f });
+            voice.streamOpen = false;
+        }
     }
 
-    auto it = audioTracks.find(name);
-    if (it == audioTracks.end()) {
-        std::cerr << "No track playing for sound: " << name << "\n";
-        return;
+    // lost events: have the worker check every track once. It gets there
+    // after every play queued so far, and what it finds comes back as
+    // ordinary events, which go stale for voices replayed in the meantime.
+    if (voicesNeedSweep.exchange(false, std::memory_order_relaxed)) {
+        sendCommand({ AudioCommand::Type::Sweep, 0, 0, nullptr, 0, 0, 0.0f });
     }
+}
 
-    MIX_Track* track = it->second;
-    if (track) {
-        MIX_StopTrack(track, 0);
-        MIX_DestroyTrack(track);
+Voice* acquireVoice(int priority) {
+    // pick up voices that finished since the last updateAudio()
+    drainStoppedVoices();
+
+    Voice* victim = nullptr;
+    for (auto& voice : voices) {
+        if (!voice.track) continue;
+        if (voice.sound == Assets::INVALID_SOUND) return &voice;
+        if (!victim || voice.priority < victim->priority ||
+            (voice.priority == victim->priority && voice.started < victim->started)) {
+            victim = &voice;
+        }
     }
 
-    audioTracks.erase(it);
+    if (!victim || victim->priority > priority) return nullptr;
+    // the worker stops what's on the track before starting the new play
+    releaseVoice(*victim);
+    ++audioStats.steals;
+    return victim;
 }
 
-void updateAudio() {
-    for (auto it = loopingTracks.begin(); it != loopingTracks.end(); ) {
-        MIX_Track* track = it->second;
-        if (track) {
-            if (!MIX_TrackPlaying(track)) {
-                MIX_PlayTrack(track, -1);
+// Never blocks on the audio device. Only waits when the ring is full, which
+// means the worker has stalled for a thousand commands; that shows up in
+// fullStalls and the worst enqueue time.
+void sendCommand(const AudioCommand& command) {
+    auto start = std::chrono::steady_clock::now();
+    while (!audioCommands.tryPush(command)) {
+        ++audioStats.fullStalls;
+        std::this_thread::yield();
+    }
+    audioSignal.fetch_add(1, std::memory_order_release);
+    audioSignal.notify_one();
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    audioStats.worstEnqueueNs = std::max(audioStats.worstEnqueueNs, (uint64_t)elapsed);
+    audioStats.queueDepth = audioCommands.size();
+    audioStats.peakQueueDepth = std::max(audioStats.peakQueueDepth, audioStats.queueDepth);
+    ++audioStats.commands;
+}
+
+void applyCommand(const AudioCommand& command) {
+    MIX_Track* track = voices[command.slot].track;
+    auto& playing = playingGeneration[command.slot];
+
+    switch (command.type) {
+    case AudioCommand::Type::Play:
+        // stop whatever was stolen first, its stopped event still carries the old generation
+        MIX_StopTrack(track, 0);
+        playing.store(command.generation, std::memory_order_relaxed);
+        if (command.io) {
+            // decoded a chunk at a time as the track plays; the mixer closes
+            // the stream when the track's input is replaced or dropped
+            if (!MIX_SetTrackIOStream(track, command.io, true)) {
+                std::cerr << "Failed to stream audio track: " << SDL_GetError() << "\n";
             }
-            ++it;
         } else {
-            it = loopingTracks.erase(it);
+            MIX_SetTrackAudio(track, command.audio);
+        }
+        MIX_SetTrackGain(track, 1.0f);
+        MIX_SetTrackStereo(track, nullptr);
+
+        // the mixer loops seamlessly on its own, -1 is forever
+        SDL_SetNumberProperty(playOptions, MIX_PROP_PLAY_LOOPS_NUMBER, (command.loops < 0) ? -1 : command.loops);
+        SDL_SetNumberProperty(playOptions, MIX_PROP_PLAY_FADE_IN_MILLISECONDS_NUMBER, command.fadeMs);
+        if (!MIX_PlayTrack(track, playOptions)) {
+            std::cerr << "Failed to play audio track: " << SDL_GetError() << "\n";
+            MIX_LockMixer(Assets::mixer);
+            if (!stoppedVoices.tryPush({ command.slot, command.generation })) voicesNeedSweep.store(true, std::memory_order_relaxed);
+            MIX_UnlockMixer(Assets::mixer);
+        }
+        break;
+    case AudioCommand::Type::Stop:
+        if (playing.load(std::memory_order_relaxed) != command.generation) break;
+        MIX_StopTrack(track, command.fadeMs > 0 ? MIX_TrackMSToFrames(track, command.fadeMs) : 0);
+        break;
+    case AudioCommand::Type::Gain:
+        if (playing.load(std::memory_order_relaxed) != command.generation) break;
+        MIX_SetTrackGain(track, command.value);
+        break;
+    case AudioCommand::Type::Pan: {
+        if (playing.load(std::memory_order_relaxed) != command.generation) break;
+        MIX_StereoGains gains{ std::min(1.0f, 1.0f - command.value), std::min(1.0f, 1.0f + command.value) };
+        MIX_SetTrackStereo(track, &gains);
+        break;
+    }
+    case AudioCommand::Type::Close:
+        if (playing.load(std::memory_order_relaxed) != command.generation) break;
+        MIX_SetTrackAudio(track, nullptr);
+        break;
+    case AudioCommand::Type::Sweep:
+        MIX_LockMixer(Assets::mixer);
+        for (uint16_t i = 0; i < Assets::MAX_VOICES; ++i) {
+            if (!voices[i].track || MIX_TrackPlaying(voices[i].track)) continue;
+            VoiceStopped event{ i, playingGeneration[i].load(std::memory_order_relaxed) };
+            if (!stoppedVoices.tryPush(event)) {
+                voicesNeedSweep.store(true, std::memory_order_relaxed);
+                break;
+            }
+        }
+        MIX_UnlockMixer(Assets::mixer);
+        break;
+    }
+}
+
+// Applies everything queued since it last woke up in one go, then sleeps
+// until the main thread signals again.
+void audioWorkerLoop() {
+    while (true) {
+        uint32_t seen = audioSignal.load(std::memory_order_acquire);
+
+        AudioCommand command;
+        while (audioCommands.tryPop(command)) {
+            applyCommand(command);
+        }
+
+        if (!audioWorkerRunning.load(std::memory_order_acquire)) break;
+        audioSignal.wait(seen, std::memory_order_acquire);
+    }
+}
+
+void drawAudioPanel() {
+    ImGui::Text("Voices: %d / %d (peak %d)", audioStats.activeVoices, Assets::MAX_VOICES, audioStats.peakVoices);
+    ImGui::Text("Stolen: %llu  dropped: %llu",
+        (unsigned long long)audioStats.steals, (unsigned long long)audioStats.dropped);
+    ImGui::Text("Commands: %llu  queue depth %zu (peak %zu)", (unsigned long long)audioStats.commands,
+        audioStats.queueDepth, audioStats.peakQueueDepth);
+    ImGui::Text("Worst enqueue: %.1f us  full stalls: %llu",
+        audioStats.worstEnqueueNs / 1000.0, (unsigned long long)audioStats.fullStalls);
+    for (const auto& voice : voices) {
+        if (voice.sound == Assets::INVALID_SOUND) continue;
+        ImGui::BulletText("%s (priority %d%s)", soundTable().sounds[voice.sound].name.c_str(),
+            voice.priority, voice.looping ? ", looping" : "");
+    }
+}
+
+// Duration of a PCM WAV from its fmt/data chunk headers, negative if it isn't one
+double wavSeconds(const unsigned char* data, size_t size) {
+    auto le32 = [](const unsigned char* p) {
+        return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+    };
+    if (size < 12 || std::memcmp(data, "RIFF", 4) != 0 || std::memcmp(data + 8, "WAVE", 4) != 0) return -1.0;
+
+    uint32_t byteRate = 0;
+    size_t pos = 12;
+    while (pos + 8 <= size) {
+        uint32_t chunkSize = le32(data + pos + 4);
+        if (std::memcmp(data + pos, "fmt ", 4) == 0 && pos + 20 <= size) {
+            byteRate = le32(data + pos + 16);
+        } else if (std::memcmp(data + pos, "data", 4) == 0) {
+            return byteRate ? (double)chunkSize / byteRate : -1.0;
         }
+        pos += 8 + chunkSize + (chunkSize & 1);
+    }
+    return -1.0;
+}
+
+bool shouldStream(const SoundSource& source) {
+    if (!Assets::streamAudio) return false;
+
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+    std::vector<unsigned char> header;
+    if (source.entry) {
+        // streaming straight out of the mapping only works for stored entries
+        if (source.entry->method != Common::Pack::Method::Stored) return false;
+        std::vector<unsigned char> scratch;
+        if (!Assets::pack.read(*source.entry, data, size, scratch)) return false;
+    } else {
+        std::error_code ec;
+        size = (size_t)std::filesystem::file_size(source.path, ec);
+        if (ec) return false;
+
+        std::ifstream in(source.path, std::ios::binary);
+        header.resize(std::min<size_t>(size, 4096));
+        in.read(reinterpret_cast<char*>(header.data()), (std::streamsize)header.size());
+        data = header.data();
+    }
+
+    if (size >= Assets::streamMinBytes) return true;
+    double seconds = wavSeconds(data, source.entry ? size : header.size());
+    return seconds >= Assets::streamMinSeconds;
+}
+
+MIX_Audio* loadSound(const SoundSource& source) {
+    bool convert = Assets::normalizeAudio && haveDeviceSpec;
+    return decodeSound(source, Assets::mixer, convert ? &deviceSpec : nullptr);
+}
+
+// Decodes a WAV and converts it to spec up front, so the mixer can add it
+// straight in without resampling or converting it every callback. Null
+// when SDL can't read it as a WAV.
+MIX_Audio* loadConverted(MIX_Mixer* target, const SDL_AudioSpec& spec, SDL_IOStream* io) {
+    SDL_AudioSpec sourceSpec;
+    Uint8* samples = nullptr;
+    Uint32 length = 0;
+    if (!SDL_LoadWAV_IO(io, true, &sourceSpec, &samples, &length)) return nullptr;
+
+    MIX_Audio* audio = nullptr;
+    Uint8* converted = nullptr;
+    int convertedLength = 0;
+    if (SDL_ConvertAudioSamples(&sourceSpec, samples, (int)length, &spec, &converted, &convertedLength)) {
+        audio = MIX_LoadRawAudio(target, converted, (size_t)convertedLength, &spec);
+        SDL_free(converted);
+    }
+    SDL_free(samples);
+    return audio;
+}
+
+// A fresh stream per voice, handed to MIX_SetTrackIOStream. Pack entries
+// are only streamed when stored, so this is a view of the mapping, which
+// stays open until every track is destroyed in unloadAllAssets().
+SDL_IOStream* openStream(const SoundSource& source) {
+    if (!source.entry) return SDL_IOFromFile(source.path.c_str(), "rb");
+
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+    std::vector<unsigned char> scratch;
+    if (source.entry->method != Common::Pack::Method::Stored || !Assets::pack.read(*source.entry, data, size, scratch)) {
+        SDL_SetError("can't stream %s out of the pack", source.path.c_str());
+        return nullptr;
+    }
+    return SDL_IOFromConstMem(data, size);
+}
+
+// Fully decodes a sound into a MIX_Audio, so it doesn't point into the
+// mapping (or the scratch buffer) afterwards. Streamed sounds never get here.
+MIX_Audio* decodeSound(const SoundSource& source, MIX_Mixer* target, const SDL_AudioSpec* convertTo) {
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+    std::vector<unsigned char> scratch;
+    if (source.entry && !Assets::pack.read(*source.entry, data, size, scratch)) {
+        std::cerr << "Failed to read audio from pack: " << source.path << "\n";
+        return nullptr;
+    }
+    auto open = [&]() {
+        return source.entry ? SDL_IOFromConstMem(data, size) : SDL_IOFromFile(source.path.c_str(), "rb");
+    };
+
+    MIX_Audio* audio = nullptr;
+    if (convertTo) {
+        SDL_IOStream* io = open();
+        if (io) audio = loadConverted(target, *convertTo, io);
+    }
+    // anything that isn't a WAV goes through SDL_mixer's own decoders
+    if (!audio) {
+        SDL_IOStream* io = open();
+        if (io) audio = MIX_LoadAudio_IO(target, io, true, true);
+    }
+
+    if (!audio) {
+        std::cerr << "Failed to load audio: " << source.path << " Error: " << SDL_GetError() << "\n";
     }
+    return audio;
 }
 
-} // namespace Assets
\ No newline at end of file
+} // namespace
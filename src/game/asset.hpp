@@ -1,10 +1,11 @@
 #pragma once
 
 #include <core/rendering/image.hpp>
+#include <common/pack.hpp>
 #include <vector>
 #include <string>
 #include <memory>
-#include <unordered_map>
+#include <cstdint>
 #include <SDL3_mixer/SDL_mixer.h>
 
 class Asset : public Core::Rendering::Image {
@@ -13,6 +14,11 @@ public:
     Asset() = default;
     ~Asset();
 
+    // makes sure the texture is resident before drawing it
+    void render(int x = 0, int y = 0, int width = -1, int height = -1, float rotation = 0.0f, int originX = 0, int originY = 0);
+    void submit(uint8_t layer, uint16_t depth, int x = 0, int y = 0, int width = -1, int height = -1, float rotation = 0.0f);
+
+    int id = -1;
     std::string path;
     int width;
     int height;
@@ -30,16 +36,87 @@ public:
 };
 
 namespace Assets {
+// image ids run 0..1151 (file stem of assets/images/<id>.png)
+constexpr int MAX_ASSETS = 1152;
+
 extern MIX_Mixer* mixer;
-extern Asset* assetList[1151];
+extern Asset* assetList[MAX_ASSETS];
+// open when assets.pack sits next to the executable, loose files otherwise
+extern Common::Pack pack;
+// Long music/ambience (at least streamMinSeconds, or streamMinBytes on disk)
+// is decoded from disk in small chunks while it plays instead of being
+// predecoded: every voice playing it opens its own stream (the file, or a
+// view of the pack mapping), closed again once the voice stops. Short SFX
+// are still predecoded. Set streamAudio to false to predecode everything.
+// Takes effect for sounds registered afterwards.
+extern bool streamAudio;
+extern float streamMinSeconds;
+extern size_t streamMinBytes;
+// Predecoded sounds are converted once at load time to the format the
+// device mixer runs at (queried in initAudio), so mixing is a plain add.
+extern bool normalizeAudio;
+
+// Sound names are interned once into a SoundId; everything after that
+// (play, stop, prefetch) is an array index, no string hashing.
+using SoundId = int32_t;
+constexpr SoundId INVALID_SOUND = -1;
+
+// One playing instance of a sound. Goes stale once its voice is stopped,
+// finishes or gets stolen, after which stop() and isPlaying() ignore it.
+struct VoiceHandle {
+    uint16_t slot = 0xFFFF;
+    uint16_t generation = 0;
+    bool valid() const { return slot != 0xFFFF; }
+};
+
+// Voices are a fixed pool of MIX_Tracks created once in initAudio(). When
+// they're all busy, play() steals the lowest priority (then oldest) voice,
+// unless everything playing outranks the new sound, which is then dropped.
+constexpr int MAX_VOICES = 32;
+enum SoundPriority : int {
+    PRIORITY_SFX = 0,
+    PRIORITY_UI = 50,
+    PRIORITY_MUSIC = 100,
+};
+
+struct AudioStats {
+    int activeVoices = 0;
+    int peakVoices = 0;
+    uint64_t steals = 0;
+    uint64_t dropped = 0;
+    // game -> audio command queue
+    uint64_t commands = 0;
+    size_t queueDepth = 0;
+    size_t peakQueueDepth = 0;
+    uint64_t worstEnqueueNs = 0;
+    uint64_t fullStalls = 0;
+};
+
 void initAudio();
+// safe to call before loadAllAssets(), ids stay valid for the whole run
+SoundId soundId(const std::string& name);
+// These only queue a command for the audio worker, so the game thread never
+// waits on the audio device. play() may still load the sound first if it
+// wasn't prefetched.
+VoiceHandle play(SoundId sound, int loops = 0, int priority = PRIORITY_SFX, int fadeInMs = 0);
+void stop(VoiceHandle voice, int fadeOutMs = 0);
+void stopAll(SoundId sound, int fadeOutMs = 0);
+// gain 1 is unchanged, pan runs from -1 (left) to 1 (right)
+void setVolume(VoiceHandle voice, float gain);
+void setPan(VoiceHandle voice, float pan);
+bool isPlaying(VoiceHandle voice);
+const AudioStats& getAudioStats();
+
+// by name: restarts the sound if it's already playing, like it always did
 void playSound(const std::string& name, int loops);
 void stopAudio(const std::string& name);
+void prefetchSounds(const std::vector<SoundId>& sounds);
 void loadAllAssets();
 void unloadAllAssets();
 void updateAudio();
 
-extern std::unordered_map<std::string, MIX_Audio*> soundMap;
-extern std::unordered_map<std::string, MIX_Track*> audioTracks;
-extern std::unordered_map<std::string, MIX_Track*> loopingTracks;
-}
\ No newline at end of file
+// --bench-mixer: mixes voiceCount looping voices offline for the given
+// length of audio, once with sounds in their file format and once converted
+// to the device format, and logs the CPU time of each. Returns an exit code.
+int benchmarkMixer(int voiceCount = MAX_VOICES, float seconds = 10.0f);
+}
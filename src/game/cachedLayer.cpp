@@ -0,0 +1,170 @@
+#include "cachedLayer.hpp"
+
+#include <common/common.hpp>
+#include <common/log.hpp>
+#include <core/debug.hpp>
+#include <core/rendering/gl2d.hpp>
+#include <core/rendering/glState.hpp>
+#include <core/rendering/gpuProfiler.hpp>
+#include <core/rendering/renderQueue.hpp>
+
+#include <algorithm>
+#include <chrono>
+
+#include <imgui.h>
+
+namespace {
+
+// every live layer, for the debug panel
+std::vector<CachedLayer*> layers;
+
+void drawLayersPanel() {
+    for (const CachedLayer* layer : layers) {
+        const auto& stats = layer->getStats();
+        size_t frames = stats.redraws + stats.cachedFrames;
+        ImGui::Text("%s: %zu objects, %zu redraws / %zu frames (%.1f%% cached), last redraw %.3f ms",
+            layer->getName().c_str(), layer->getMemberCount(), stats.redraws, frames,
+            frames ? 100.0 * stats.cachedFrames / frames : 0.0, stats.lastRedrawMs);
+        ImGui::BulletText("dirty: %zu marked, %zu member changes", stats.markedDirty, stats.memberChanges);
+    }
+}
+
+} // namespace
+
+bool CachedLayer::Snapshot::operator!=(const Snapshot& other) const {
+    return x != other.x || y != other.y || width != other.width || height != other.height ||
+        alpha != other.alpha || invisible != other.invisible || forceShow != other.forceShow ||
+        asset != other.asset || texture != other.texture;
+}
+
+CachedLayer::CachedLayer(std::string name) : m_name(std::move(name)) {
+    if (layers.empty()) Core::Debug::addPanel("Cached Layers", drawLayersPanel);
+    layers.push_back(this);
+}
+
+CachedLayer::~CachedLayer() {
+    if (m_texture) {
+        Core::Rendering::GL2D::forgetTexture(m_texture);
+        Core::Rendering::GLState::forgetTexture(m_texture);
+        glDeleteTextures(1, &m_texture);
+    }
+    if (m_fbo) glDeleteFramebuffers(1, &m_fbo);
+
+    layers.erase(std::remove(layers.begin(), layers.end(), this), layers.end());
+    if (layers.empty()) Core::Debug::removePanel("Cached Layers");
+}
+
+void CachedLayer::add(Object* object) {
+    m_members.push_back(object);
+    m_snapshots.push_back(snapshot(*object));
+    m_dirty = true;
+}
+
+CachedLayer::Snapshot CachedLayer::snapshot(Object& object) {
+    Snapshot snap;
+    snap.x = object.getPosition(0);
+    snap.y = object.getPosition(1);
+    snap.width = object.width;
+    snap.height = object.height;
+    snap.alpha = object.alpha;
+    snap.invisible = object.isInvisible;
+    snap.forceShow = object.forceShow;
+    snap.asset = object.currentAsset;
+    // residency can evict and reload it under a new name
+    snap.texture = object.currentAsset ? object.currentAsset->getTextureID() : 0;
+    return snap;
+}
+
+bool CachedLayer::createTarget() {
+    m_width = Common::width;
+    m_height = Common::height;
+
+    glGenTextures(1, &m_texture);
+    Core::Rendering::GLState::bindTexture(0, m_texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_width, m_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    GLint previous = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous);
+    glGenFramebuffers(1, &m_fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_texture, 0);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)previous);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        char buf[128];
+        std::snprintf(buf, sizeof(buf), "CachedLayer %s: framebuffer incomplete (0x%x)", m_name.c_str(), status);
+        Common::error(buf);
+        Core::Rendering::GLState::forgetTexture(m_texture);
+        glDeleteTextures(1, &m_texture);
+        glDeleteFramebuffers(1, &m_fbo);
+        m_texture = m_fbo = 0;
+        return false;
+    }
+    return true;
+}
+
+void CachedLayer::redraw() {
+    namespace GL2D = Core::Rendering::GL2D;
+    namespace GLState = Core::Rendering::GLState;
+    Core::Rendering::GPUProfiler::Scope scope(m_name.c_str());
+    auto start = std::chrono::steady_clock::now();
+
+    // only happens when something changed, so asking GL what to go back to is fine
+    GL2D::flush();
+    GLint previous = 0, viewport[4];
+    GLfloat clearColor[4];
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    GLState::viewport(0, 0, m_width, m_height);
+    glClearColor(0.f, 0.f, 0.f, 0.f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+
+    GL2D::setPremultipliedTarget(true);
+    for (Object* member : m_members) member->render();
+    GL2D::setPremultipliedTarget(false);   // flushes
+
+    glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)previous);
+    GLState::viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+    for (size_t i = 0; i < m_members.size(); ++i) m_snapshots[i] = snapshot(*m_members[i]);
+    m_dirty = false;
+    ++m_stats.redraws;
+    m_stats.lastRedrawMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void CachedLayer::submit(uint8_t layer, uint16_t depth) {
+    if (!m_fbo && !m_targetFailed && !createTarget()) m_targetFailed = true;
+    if (m_targetFailed) {
+        // no offscreen target, draw the members directly instead
+        for (Object* member : m_members) member->submit(layer, depth);
+        return;
+    }
+
+    bool changed = false;
+    for (size_t i = 0; i < m_members.size() && !changed; ++i) changed = snapshot(*m_members[i]) != m_snapshots[i];
+
+    if (m_dirty || changed) {
+        if (m_dirty) ++m_stats.markedDirty;
+        else ++m_stats.memberChanges;
+        redraw();
+    } else {
+        ++m_stats.cachedFrames;
+    }
+
+    // the texture's first row is the bottom of the layer, so v runs 1 -> 0
+    Core::Rendering::GL2D::Sprite sprite{};
+    sprite.width = (float)m_width;
+    sprite.height = (float)m_height;
+    sprite.setUV(0.f, 1.f, 1.f, 0.f);
+    sprite.setColor(1.f, 1.f, 1.f, 1.f);
+    Core::Rendering::RenderQueue::submit(layer, depth, sprite, m_texture, { GL_ONE, GL_ONE_MINUS_SRC_ALPHA });
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "gameObject.hpp"
+#include <glad/glad.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A group of objects drawn once into a game-sized texture and then composited
+// as a single quad until something in it changes. A member counts as changed
+// when its position, size, alpha, visibility or current asset (or that
+// asset's texture) differs from the last redraw; anything else has to call
+// markDirty().
+//
+// Members are drawn into a transparent target, so the layer is composited
+// premultiplied. Normal and additive members come out the same as drawing
+// them directly; blend modes that read the framebuffer (multiply, screen)
+// only see the layer's own contents and don't belong in one.
+class CachedLayer {
+public:
+    explicit CachedLayer(std::string name);
+    ~CachedLayer();
+    CachedLayer(const CachedLayer&) = delete;
+    CachedLayer& operator=(const CachedLayer&) = delete;
+
+    void add(Object* object);
+    void markDirty() { m_dirty = true; }
+
+    // redraws into the texture if needed, then queues the composite quad
+    void submit(uint8_t layer, uint16_t depth = 0);
+
+    struct Stats {
+        size_t redraws = 0;
+        size_t cachedFrames = 0;    // composited without a redraw
+        size_t markedDirty = 0;     // redraws asked for through markDirty()
+        size_t memberChanges = 0;   // redraws caused by a member changing
+        double lastRedrawMs = 0.0;  // CPU side
+    };
+    const Stats& getStats() const { return m_stats; }
+    const std::string& getName() const { return m_name; }
+    size_t getMemberCount() const { return m_members.size(); }
+
+private:
+    struct Snapshot {
+        int x = 0, y = 0, width = 0, height = 0;
+        float alpha = 0.f;
+        bool invisible = false;
+        bool forceShow = false;
+        const Asset* asset = nullptr;
+        GLuint texture = 0;
+
+        bool operator!=(const Snapshot& other) const;
+    };
+
+    static Snapshot snapshot(Object& object);
+    bool createTarget();
+    void redraw();
+
+    std::string m_name;
+    std::vector<Object*> m_members;
+    std::vector<Snapshot> m_snapshots;
+    bool m_dirty = true;
+
+    int m_width = 0, m_height = 0;
+    GLuint m_fbo = 0;
+    GLuint m_texture = 0;
+    bool m_targetFailed = false;
+
+    Stats m_stats;
+};
@@ -2,6 +2,7 @@
 
 #include <core/rendering/shapes.hpp>
 #include <core/rendering/colour.hpp>
+#include <core/rendering/renderQueue.hpp>
 
 #include <core/input.hpp>
 #include <core/game.hpp>
@@ -88,6 +89,23 @@ void Object::render() {
     }
 }
 
+void Object::submit(uint8_t layer, uint16_t depth) {
+    if (forceShow) {
+        int px = getPosition(0), py = getPosition(1), w = width, h = height;
+        Core::Rendering::RenderQueue::submit(layer, depth, [px, py, w, h] {
+            Core::Rendering::setColor(1.0f, 0.0f, 1.0f, 1.0f);
+            Core::Rendering::Shapes::rectangle(false, px, py, w, h);
+            Core::Rendering::setColor(1.0f, 1.0f, 1.0f, 1.0f);
+        });
+    } else {
+        if (isInvisible) return;
+        if (currentAsset) {
+            currentAsset->setTint(1.0f, 1.0f, 1.0f, alpha);
+            currentAsset->submit(layer, depth, getPosition(0), getPosition(1), width, height);
+        }
+    }
+}
+
 int Object::getPosition(bool axis) {
     if (axis) {
         if (floating) {
@@ -27,6 +27,8 @@ public:
     Object(Asset *asset, int x, int y, int *gx, int *gy);
     Object(int x, int y, int *gx, int *gy, int width, int height);
     void render();
+    // render() through the RenderQueue
+    void submit(uint8_t layer, uint16_t depth = 0);
     void setVisibility(bool visible);
     int getPosition(bool axis);
     bool isMouseHovering();
@@ -0,0 +1,778 @@
+#include "residency.hpp"
+#include "asset.hpp"
+
+#include <core/game.hpp>
+#include <core/debug.hpp>
+#include <core/helpers/workerPool.hpp>
+#include <core/rendering/atlas.hpp>
+#include <core/rendering/textureCache.hpp>
+#include <common/common.hpp>
+#include <common/log.hpp>
+#include <imgui.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+
+namespace Assets {
+namespace Residency {
+
+namespace {
+
+using Clock = std::chrono::high_resolution_clock;
+
+inline uint64_t elapsedNs(Clock::time_point since) {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - since).count();
+}
+
+struct DecodedImage {
+    int index = -1;
+    Core::Rendering::PixelData data;
+    bool ok = false;
+};
+
+// Workers push finished images, the GL thread pops and uploads them.
+// Bounded so a slow upload side can't pile up hundreds of MB of decoded pixels.
+// The background queue is unbounded instead: nothing drains it while a
+// synchronous batch waits on the same workers.
+class DecodedQueue {
+public:
+    explicit DecodedQueue(size_t capacity = SIZE_MAX) : m_capacity(capacity) {}
+
+    void push(DecodedImage&& img) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notFull.wait(lock, [this] { return m_items.size() < m_capacity; });
+        m_items.push_back(std::move(img));
+        m_notEmpty.notify_one();
+    }
+
+    DecodedImage pop() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notEmpty.wait(lock, [this] { return !m_items.empty(); });
+        DecodedImage img = std::move(m_items.front());
+        m_items.pop_front();
+        m_notFull.notify_one();
+        return img;
+    }
+
+    bool tryPop(DecodedImage& out) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_items.empty()) return false;
+        out = std::move(m_items.front());
+        m_items.pop_front();
+        m_notFull.notify_one();
+        return true;
+    }
+
+private:
+    size_t m_capacity;
+    std::deque<DecodedImage> m_items;
+    std::mutex m_mutex;
+    std::condition_variable m_notEmpty;
+    std::condition_variable m_notFull;
+};
+
+// Small and medium sprites (menu text, selector, blips, line/fan frames...)
+// go into shared atlas pages, full screen stuff keeps its own texture.
+constexpr int ATLAS_MAX_SIDE = 1024;
+constexpr int ATLAS_MAX_AREA = 256 * 256;
+
+bool wantsAtlas(int width, int height) {
+    return width <= ATLAS_MAX_SIDE && height <= ATLAS_MAX_SIDE &&
+           width * height <= ATLAS_MAX_AREA;
+}
+
+struct Slot {
+    std::string path;
+    const Common::Pack::Entry* packEntry = nullptr; // set when loading from assets.pack
+    uint64_t cacheKey = 0;
+    int64_t mtime = 0;
+    uint64_t fileSize = 0;
+    uint64_t contentHash = 0; // 0 until it's been decoded or found in the cache
+    Core::Rendering::TrimRect trim; // same, zero width until known
+    int width = 0;
+    int height = 0;
+    bool registered = false;
+    bool atlased = false;
+    bool resident = false;
+    bool staged = false;
+    bool pending = false; // background load in flight
+    int pins = 0;
+    uint64_t lastUse = 0;
+};
+
+Slot slots[MAX_ASSETS];
+Core::Rendering::TextureCache cache;
+std::string cachePath;
+size_t budget = 512ull * 1024 * 1024;
+uint64_t useCounter = 0;
+Stats stats;
+
+// One texture per distinct image content. Byte-identical images (reused
+// blip/static frames...) all point at the first one that got uploaded.
+struct SharedTexture {
+    std::weak_ptr<Core::Rendering::Texture> texture;
+    int residents = 0;
+};
+std::unordered_map<uint64_t, SharedTexture> sharedTextures;
+
+// background loads started by prefetchAsync(), finished a few per frame by update()
+DecodedQueue asyncDecoded;
+std::deque<int> asyncCached;
+
+// how long update() may spend uploading per frame
+constexpr uint64_t ASYNC_UPLOAD_BUDGET_NS = 2'000'000;
+
+struct BatchTimings {
+    uint64_t readNs = 0;
+    uint64_t decodeNs = 0;
+    uint64_t uploadNs = 0;
+    size_t hits = 0;
+    size_t decoded = 0;
+    size_t shared = 0;
+};
+
+// atlas packing dedups by content too, duplicates copy the first one's UVs after finish()
+struct AtlasDedup {
+    std::unordered_map<uint64_t, int> first;
+    std::vector<std::pair<int, int>> aliases; // (duplicate, original)
+};
+
+// what the slot's texture costs, which is only its trimmed area once that's known
+size_t textureBytes(const Slot& slot) {
+    if (slot.trim.width > 0) return (size_t)slot.trim.width * slot.trim.height * 4;
+    return (size_t)slot.width * slot.height * 4;
+}
+
+size_t untrimmedBytes(const Slot& slot) {
+    return (size_t)slot.width * slot.height * 4;
+}
+
+void adopt(Slot& slot, const Core::Rendering::PixelData& data) {
+    slot.contentHash = data.hash;
+    slot.trim = data.trim;
+}
+
+const Core::Rendering::TextureCache::Entry* peekCached(const Slot& slot) {
+    return cache.peek(slot.cacheKey, slot.mtime, slot.fileSize);
+}
+
+// cached texels for the slot, nullptr on a miss; picks up the cached hash and trim on the way
+const unsigned char* findCached(Slot& slot) {
+    const Core::Rendering::TextureCache::Entry* entry = nullptr;
+    const unsigned char* pixels = cache.find(slot.cacheKey, slot.mtime, slot.fileSize, &entry);
+    if (!pixels || (int)entry->width != slot.width || (int)entry->height != slot.height) return nullptr;
+
+    slot.contentHash = entry->contentHash;
+    slot.trim = entry->trim();
+    return pixels;
+}
+
+bool readPngSize(const unsigned char* header, size_t size, int& width, int& height) {
+    // IHDR is always the first chunk: 8 byte signature, 8 byte chunk header, then w/h big endian
+    if (size < 24) return false;
+    if (header[1] != 'P' || header[2] != 'N' || header[3] != 'G') return false;
+
+    auto be32 = [](const unsigned char* p) {
+        return (int)((uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | (uint32_t)p[3]);
+    };
+    width = be32(header + 16);
+    height = be32(header + 20);
+    return width > 0 && height > 0;
+}
+
+bool readPngSize(const Slot& slot, int& width, int& height) {
+    if (slot.packEntry) {
+        const unsigned char* data = nullptr;
+        size_t size = 0;
+        std::vector<unsigned char> scratch;
+        return Assets::pack.read(*slot.packEntry, data, size, scratch) && readPngSize(data, size, width, height);
+    }
+
+    std::ifstream in(slot.path, std::ios::binary);
+    unsigned char header[24];
+    if (!in.read(reinterpret_cast<char*>(header), sizeof(header))) return false;
+    return readPngSize(header, sizeof(header), width, height);
+}
+
+bool decodeFile(const std::string& path, const Common::Pack::Entry* packEntry, Core::Rendering::PixelData& out,
+    uint64_t& readNs, uint64_t& decodeNs) {
+    if (packEntry) {
+        // stored entries decode straight out of the mapping
+        auto t0 = Clock::now();
+        const unsigned char* data = nullptr;
+        size_t size = 0;
+        std::vector<unsigned char> scratch;
+        bool ok = Assets::pack.read(*packEntry, data, size, scratch);
+        readNs = elapsedNs(t0);
+        if (!ok) {
+            Common::error("Unable to read image from pack: " + path);
+            return false;
+        }
+
+        auto t1 = Clock::now();
+        ok = Core::Rendering::Image::decode(data, size, out);
+        decodeNs = elapsedNs(t1);
+        return ok;
+    }
+
+    auto t0 = Clock::now();
+    size_t size = 0;
+    void* bytes = SDL_LoadFile(path.c_str(), &size);
+    readNs = elapsedNs(t0);
+    if (!bytes) {
+        Common::error("Unable to read image: " + path + " SDL Error: " + std::string(SDL_GetError()));
+        return false;
+    }
+
+    auto t1 = Clock::now();
+    bool ok = Core::Rendering::Image::decode(bytes, size, out);
+    decodeNs = elapsedNs(t1);
+    SDL_free(bytes);
+    return ok;
+}
+
+void markResident(int id) {
+    Slot& slot = slots[id];
+    slot.resident = true;
+    slot.lastUse = ++useCounter;
+    stats.residentCount++;
+
+    // only the first resident copy of some content costs VRAM
+    if (sharedTextures[slot.contentHash].residents++ == 0) {
+        stats.residentBytes += textureBytes(slot);
+    } else {
+        stats.sharedCount++;
+        stats.sharedBytes += textureBytes(slot);
+    }
+}
+
+// points id at an already resident texture with the same content, skipping read/decode/upload
+bool tryShare(int id) {
+    Slot& slot = slots[id];
+    if (!slot.contentHash) return false;
+
+    auto it = sharedTextures.find(slot.contentHash);
+    if (it == sharedTextures.end() || it->second.residents == 0) return false;
+    auto texture = it->second.texture.lock();
+    if (!texture) return false;
+
+    assetList[id]->setTexture(std::move(texture));
+    assetList[id]->setTrim(slot.width, slot.height, slot.trim);
+    markResident(id);
+    return true;
+}
+
+// pixels is the full decoded image, only the slot's trim rectangle gets uploaded
+void upload(int id, const unsigned char* pixels) {
+    Slot& slot = slots[id];
+    if (tryShare(id)) return;
+
+    const Core::Rendering::TrimRect& trim = slot.trim;
+    const unsigned char* origin = pixels + ((size_t)trim.y * slot.width + trim.x) * 4;
+    auto texture = Core::Rendering::Texture::create(origin, trim.width, trim.height, slot.width);
+    if (!texture) {
+        Common::error("Unable to create texture for " + slot.path);
+        return;
+    }
+    sharedTextures[slot.contentHash].texture = texture;
+    assetList[id]->setTexture(std::move(texture));
+    assetList[id]->setTrim(slot.width, slot.height, trim);
+    markResident(id);
+}
+
+void addToAtlas(int id, Core::Rendering::PixelData&& data, const unsigned char* borrowed,
+    Core::Rendering::AtlasBuilder& atlas, AtlasDedup& dedup) {
+    Slot& slot = slots[id];
+    auto [it, inserted] = dedup.first.emplace(slot.contentHash, id);
+    if (!inserted) {
+        dedup.aliases.emplace_back(id, it->second);
+        return;
+    }
+    if (borrowed) atlas.add(assetList[id], borrowed, slot.width, slot.height, slot.trim);
+    else atlas.add(assetList[id], std::move(data));
+}
+
+void stage(int id, const Core::Rendering::PixelData& data) {
+    Slot& slot = slots[id];
+    if (slot.staged) return;
+    cache.stage(slot.cacheKey, slot.mtime, slot.fileSize, data);
+    slot.staged = true;
+}
+
+// Loads a set of non-resident images: cache hits come straight from the
+// mapping, misses are decoded on the worker pool and uploaded here.
+BatchTimings loadBatch(const std::vector<int>& ids, Core::Rendering::AtlasBuilder* atlas, AtlasDedup* dedup) {
+    BatchTimings timings;
+
+    std::vector<int> misses;
+    for (int id : ids) {
+        if (!atlas && tryShare(id)) {
+            timings.shared++;
+            continue;
+        }
+
+        const unsigned char* pixels = findCached(slots[id]);
+        if (!pixels) {
+            misses.push_back(id);
+            continue;
+        }
+
+        auto t0 = Clock::now();
+        if (atlas) addToAtlas(id, {}, pixels, *atlas, *dedup);
+        else upload(id, pixels);
+        timings.uploadNs += elapsedNs(t0);
+        timings.hits++;
+    }
+
+    if (misses.empty()) return timings;
+
+    auto& pool = Core::Helpers::WorkerPool::get();
+    DecodedQueue queue(pool.size() * 2);
+    std::atomic<uint64_t> readNs{0};
+    std::atomic<uint64_t> decodeNs{0};
+
+    for (int id : misses) {
+        pool.submit([&queue, &readNs, &decodeNs, id, path = slots[id].path, packEntry = slots[id].packEntry] {
+            DecodedImage img;
+            img.index = id;
+            uint64_t r = 0, d = 0;
+            img.ok = decodeFile(path, packEntry, img.data, r, d);
+            readNs += r;
+            decodeNs += d;
+            queue.push(std::move(img));
+        });
+    }
+
+    for (size_t i = 0; i < misses.size(); ++i) {
+        DecodedImage img = queue.pop();
+        if (!img.ok) continue;
+
+        Slot& slot = slots[img.index];
+        if (img.data.width != slot.width || img.data.height != slot.height) {
+            Common::warn("Image size changed since it was registered: " + slot.path);
+            continue;
+        }
+        stage(img.index, img.data);
+        adopt(slot, img.data);
+
+        auto t0 = Clock::now();
+        if (atlas) addToAtlas(img.index, std::move(img.data), nullptr, *atlas, *dedup);
+        else upload(img.index, img.data.pixels.data());
+        timings.uploadNs += elapsedNs(t0);
+        timings.decoded++;
+    }
+
+    timings.readNs = readNs.load();
+    timings.decodeNs = decodeNs.load();
+    return timings;
+}
+
+void finishPending(int id, const Core::Rendering::PixelData* decoded) {
+    Slot& slot = slots[id];
+    slot.pending = false;
+    stats.pendingCount--;
+    if (slot.resident) return;
+
+    if (decoded) {
+        if (decoded->width != slot.width || decoded->height != slot.height) {
+            Common::warn("Image size changed since it was registered: " + slot.path);
+            return;
+        }
+        stage(id, *decoded);
+        adopt(slot, *decoded);
+        upload(id, decoded->pixels.data());
+        return;
+    }
+
+    if (tryShare(id)) return;
+    if (const unsigned char* pixels = findCached(slot)) upload(id, pixels);
+}
+
+// uploads one finished background load, false when nothing is ready yet
+bool finishOneAsync() {
+    if (!asyncCached.empty()) {
+        int id = asyncCached.front();
+        asyncCached.pop_front();
+        finishPending(id, nullptr);
+        return true;
+    }
+
+    DecodedImage img;
+    if (!asyncDecoded.tryPop(img)) return false;
+    finishPending(img.index, img.ok ? &img.data : nullptr);
+    return true;
+}
+
+// blocks until none of ids is loading in the background anymore,
+// returns how many of them were still in flight
+size_t waitPending(const std::vector<int>& ids) {
+    size_t waited = 0;
+    for (int id : ids) {
+        if (id >= 0 && id < MAX_ASSETS && slots[id].pending) ++waited;
+    }
+    if (waited == 0) return 0;
+
+    while (!asyncCached.empty()) finishOneAsync();
+    for (;;) {
+        bool outstanding = false;
+        for (int id : ids) {
+            if (id >= 0 && id < MAX_ASSETS && slots[id].pending) {
+                outstanding = true;
+                break;
+            }
+        }
+        if (!outstanding) break;
+
+        DecodedImage img = asyncDecoded.pop();
+        finishPending(img.index, img.ok ? &img.data : nullptr);
+    }
+    return waited;
+}
+
+void evict(int id) {
+    Slot& slot = slots[id];
+    assetList[id]->setTexture(nullptr);
+    slot.resident = false;
+    stats.residentCount--;
+    stats.evictions++;
+
+    // the texture itself only goes away once its last user is evicted
+    auto it = sharedTextures.find(slot.contentHash);
+    if (--it->second.residents == 0) {
+        stats.residentBytes -= textureBytes(slot);
+        sharedTextures.erase(it);
+    } else {
+        stats.sharedCount--;
+        stats.sharedBytes -= textureBytes(slot);
+    }
+}
+
+void enforceBudget(int keep) {
+    while (stats.residentBytes > budget) {
+        int victim = -1;
+        uint64_t oldest = UINT64_MAX;
+        for (int id = 0; id < MAX_ASSETS; ++id) {
+            const Slot& slot = slots[id];
+            if (!slot.resident || slot.atlased || slot.pins > 0 || id == keep) continue;
+            if (slot.lastUse < oldest) {
+                oldest = slot.lastUse;
+                victim = id;
+            }
+        }
+        if (victim < 0) break; // everything left is pinned
+        evict(victim);
+    }
+}
+
+// commit() drops the mapping, so reopen it and mark every registered entry as still live
+void flushCache() {
+    cache.commit();
+    cache.open(cachePath);
+    for (auto& slot : slots) {
+        if (slot.registered) peekCached(slot);
+        slot.staged = false;
+    }
+}
+
+void drawDebugPanel() {
+    ImGui::Text("Budget: %s", Common::formatBytes(budget).c_str());
+    ImGui::Text("Resident: %s in %zu textures (atlas %s)",
+        Common::formatBytes(stats.residentBytes).c_str(), stats.residentCount,
+        Common::formatBytes(stats.atlasBytes).c_str());
+    ImGui::Text("Pinned: %zu  Loading: %zu", stats.pinnedCount, stats.pendingCount);
+    ImGui::Text("Shared: %zu images reuse an identical texture (%s saved)",
+        stats.sharedCount, Common::formatBytes(stats.sharedBytes).c_str());
+    ImGui::Text("Hits: %llu  Misses: %llu  Evictions: %llu",
+        (unsigned long long)stats.hits, (unsigned long long)stats.misses,
+        (unsigned long long)stats.evictions);
+}
+
+} // namespace
+
+void init(const std::string& imageDir) {
+    auto wallStart = Clock::now();
+
+    cachePath = Core::Game::getSaveDirectory() + "texturecache.bin";
+    cache.open(cachePath);
+
+    std::vector<int> atlasIds;
+    size_t registered = 0;
+    auto registerImage = [&](int id, const std::string& path, const std::string& filename,
+        int64_t mtime, uint64_t fileSize, const Common::Pack::Entry* packEntry) {
+        if (id < 0 || id >= MAX_ASSETS) {
+            Common::warn("Image id out of range, skipping: " + path);
+            return;
+        }
+
+        Slot& slot = slots[id];
+        slot.path = path;
+        slot.packEntry = packEntry;
+        slot.cacheKey = Core::Rendering::TextureCache::makeKey(filename);
+        slot.mtime = mtime;
+        slot.fileSize = fileSize;
+
+        if (const auto* entry = peekCached(slot)) {
+            slot.width = (int)entry->width;
+            slot.height = (int)entry->height;
+            slot.contentHash = entry->contentHash;
+            slot.trim = entry->trim();
+        } else if (!readPngSize(slot, slot.width, slot.height)) {
+            Core::Rendering::PixelData data;
+            uint64_t readNs = 0, decodeNs = 0;
+            if (!decodeFile(slot.path, slot.packEntry, data, readNs, decodeNs)) return;
+            slot.width = data.width;
+            slot.height = data.height;
+            adopt(slot, data);
+        }
+        slot.registered = true;
+
+        Asset* asset = new Asset();
+        asset->id = id;
+        asset->path = slot.path;
+        asset->width = slot.width;
+        asset->height = slot.height;
+        asset->setDimensions(slot.width, slot.height);
+        assetList[id] = asset;
+        ++registered;
+
+        // mostly transparent overlays can fit once trimmed, when the cache already knows that
+        int packedWidth = slot.trim.width > 0 ? slot.trim.width : slot.width;
+        int packedHeight = slot.trim.width > 0 ? slot.trim.height : slot.height;
+        if (wantsAtlas(packedWidth, packedHeight)) atlasIds.push_back(id);
+    };
+
+    if (Assets::pack.isOpen()) {
+        // the index is already keyed by id, no directory walk or name parsing
+        const auto* end = Assets::pack.end(Common::Pack::Type::Image);
+        for (const auto* entry = Assets::pack.begin(Common::Pack::Type::Image); entry != end; ++entry) {
+            std::string filename(Assets::pack.name(*entry));
+            // sourceTime/size match the loose file it was packed from, so the texture cache stays valid
+            registerImage(entry->id, imageDir + filename, filename, entry->sourceTime, entry->size, entry);
+        }
+    } else {
+        for (const auto& entry : std::filesystem::directory_iterator(imageDir)) {
+            if (!entry.is_regular_file()) continue;
+            registerImage(std::stoi(entry.path().stem().string()), entry.path().string(),
+                entry.path().filename().string(),
+                (int64_t)entry.last_write_time().time_since_epoch().count(), (uint64_t)entry.file_size(), nullptr);
+        }
+    }
+
+    Core::Rendering::AtlasBuilder atlas;
+    AtlasDedup dedup;
+    BatchTimings timings = loadBatch(atlasIds, &atlas, &dedup);
+
+    auto atlasStart = Clock::now();
+    atlas.finish();
+    for (auto [duplicate, original] : dedup.aliases) {
+        assetList[duplicate]->shareTexture(*assetList[original]);
+    }
+    timings.uploadNs += elapsedNs(atlasStart);
+
+    for (int id : atlasIds) {
+        if (!assetList[id]->isLoaded()) continue;
+        slots[id].atlased = true;
+        slots[id].resident = true;
+        stats.residentCount++;
+    }
+    stats.atlasBytes = atlas.getPageCount() * (size_t)atlas.getPageSize() * atlas.getPageSize() * 4;
+    stats.residentBytes += stats.atlasBytes;
+
+    flushCache();
+
+    char buf[256];
+    std::snprintf(buf, sizeof(buf),
+        "Registered %zu images, packed %zu sprites into %zu atlas pages in %.1f ms on %zu workers "
+        "(read %.1f ms, decode %.1f ms across workers; upload %.1f ms; %zu cache hits, %zu decoded)",
+        registered, atlas.getImageCount(), atlas.getPageCount(), elapsedNs(wallStart) / 1e6,
+        Core::Helpers::WorkerPool::get().size(), timings.readNs / 1e6, timings.decodeNs / 1e6,
+        timings.uploadNs / 1e6, timings.hits, timings.decoded);
+    Common::info(buf);
+
+    // what dedup buys us if everything we know the content of were resident at once
+    std::unordered_map<uint64_t, int> copies;
+    size_t hashed = 0, duplicates = 0, duplicateBytes = 0;
+    for (const auto& slot : slots) {
+        if (!slot.registered || !slot.contentHash) continue;
+        ++hashed;
+        if (copies[slot.contentHash]++ > 0) {
+            ++duplicates;
+            duplicateBytes += textureBytes(slot);
+        }
+    }
+    size_t trimmedBytes = 0, fullBytes = 0, trimmed = 0;
+    for (const auto& slot : slots) {
+        if (!slot.registered || slot.trim.width == 0) continue;
+        ++trimmed;
+        trimmedBytes += textureBytes(slot);
+        fullBytes += untrimmedBytes(slot);
+    }
+    if (fullBytes > 0) {
+        std::snprintf(buf, sizeof(buf), "Trim: %zu images need %s of texels instead of %s (%.0f%%)",
+            trimmed, Common::formatBytes(trimmedBytes).c_str(), Common::formatBytes(fullBytes).c_str(),
+            100.0 * trimmedBytes / fullBytes);
+        Common::info(buf);
+    }
+
+    std::snprintf(buf, sizeof(buf),
+        "Dedup: %zu of %zu hashed images are copies of another (%zu unique textures, %s saved; %zu in the atlas)",
+        duplicates, hashed, copies.size(), Common::formatBytes(duplicateBytes).c_str(), dedup.aliases.size());
+    Common::info(buf);
+
+    Core::Debug::addPanel("Textures", drawDebugPanel);
+}
+
+void shutdown() {
+    Core::Debug::removePanel("Textures");
+
+    // drop whatever is still loading, the workers only touch the queue
+    Core::Helpers::WorkerPool::get().waitIdle();
+    asyncCached.clear();
+    DecodedImage img;
+    while (asyncDecoded.tryPop(img)) {}
+
+    cache.commit();
+    for (auto& slot : slots) slot = Slot{};
+    sharedTextures.clear();
+    stats = Stats{};
+}
+
+void setBudget(size_t bytes) {
+    budget = bytes;
+    enforceBudget(-1);
+}
+
+size_t getBudget() {
+    return budget;
+}
+
+void pin(const std::vector<int>& ids) {
+    for (int id : ids) {
+        if (id < 0 || id >= MAX_ASSETS || !slots[id].registered) continue;
+        if (slots[id].pins++ == 0) stats.pinnedCount++;
+    }
+    prefetch(ids);
+}
+
+void unpin(const std::vector<int>& ids) {
+    for (int id : ids) {
+        if (id < 0 || id >= MAX_ASSETS || slots[id].pins == 0) continue;
+        if (--slots[id].pins == 0) stats.pinnedCount--;
+    }
+    enforceBudget(-1);
+}
+
+void prefetch(const std::vector<int>& ids) {
+    auto start = Clock::now();
+    size_t waited = waitPending(ids);
+
+    std::vector<int> pending;
+    for (int id : ids) {
+        if (id < 0 || id >= MAX_ASSETS) continue;
+        Slot& slot = slots[id];
+        if (!slot.registered || slot.resident) continue;
+        if (std::find(pending.begin(), pending.end(), id) != pending.end()) continue;
+        pending.push_back(id);
+    }
+    if (pending.empty() && waited == 0) return;
+
+    BatchTimings timings = loadBatch(pending, nullptr, nullptr);
+    enforceBudget(-1);
+
+    char buf[192];
+    std::snprintf(buf, sizeof(buf),
+        "Loaded %zu textures in %.1f ms (%zu cache hits, %zu decoded, %zu shared, waited on %zu background loads)",
+        pending.size(), elapsedNs(start) / 1e6, timings.hits, timings.decoded, timings.shared, waited);
+    Common::info(buf);
+}
+
+void prefetchAsync(const std::vector<int>& ids) {
+    auto& pool = Core::Helpers::WorkerPool::get();
+    size_t cached = 0, decoding = 0;
+
+    for (int id : ids) {
+        if (id < 0 || id >= MAX_ASSETS) continue;
+        Slot& slot = slots[id];
+        if (!slot.registered || slot.resident || slot.pending) continue;
+        if (tryShare(id)) continue;
+
+        slot.pending = true;
+        stats.pendingCount++;
+
+        const auto* entry = peekCached(slot);
+        if (entry && (int)entry->width == slot.width && (int)entry->height == slot.height) {
+            // already decoded on disk, only the upload is left
+            asyncCached.push_back(id);
+            ++cached;
+            continue;
+        }
+
+        pool.submit([id, path = slot.path, packEntry = slot.packEntry] {
+            DecodedImage img;
+            img.index = id;
+            uint64_t readNs = 0, decodeNs = 0;
+            img.ok = decodeFile(path, packEntry, img.data, readNs, decodeNs);
+            asyncDecoded.push(std::move(img));
+        });
+        ++decoding;
+    }
+
+    if (cached + decoding == 0) return;
+    char buf[128];
+    std::snprintf(buf, sizeof(buf), "Background loading %zu textures (%zu from cache, %zu decoding)",
+        cached + decoding, cached, decoding);
+    Common::info(buf);
+}
+
+void update() {
+    if (stats.pendingCount == 0) return;
+
+    auto start = Clock::now();
+    bool uploaded = false;
+    while (elapsedNs(start) < ASYNC_UPLOAD_BUDGET_NS && finishOneAsync()) uploaded = true;
+    if (uploaded) enforceBudget(-1);
+}
+
+void touch(Asset* asset) {
+    int id = asset->id;
+    if (id < 0 || id >= MAX_ASSETS || !slots[id].registered) return;
+
+    Slot& slot = slots[id];
+    if (slot.pending) waitPending({ id });
+    if (slot.resident) {
+        stats.hits++;
+        slot.lastUse = ++useCounter;
+        return;
+    }
+
+    stats.misses++;
+    if (tryShare(id)) {
+        enforceBudget(id);
+        return;
+    }
+
+    if (const unsigned char* pixels = findCached(slot)) {
+        upload(id, pixels);
+    } else {
+        Core::Rendering::PixelData data;
+        uint64_t readNs = 0, decodeNs = 0;
+        if (!decodeFile(slot.path, slot.packEntry, data, readNs, decodeNs)) return;
+        stage(id, data);
+        adopt(slot, data);
+        upload(id, data.pixels.data());
+    }
+    enforceBudget(id);
+}
+
+const Stats& getStats() {
+    return stats;
+}
+
+} // namespace Residency
+} // namespace Assets
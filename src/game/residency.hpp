@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Asset;
+
+namespace Assets {
+namespace Residency {
+
+// Keeps image textures in VRAM only while they are wanted.
+//
+// Every image is registered up front (path + dimensions, no texels).
+// Small sprites are packed into the atlas at startup and stay resident;
+// everything else loads on first render or when a state pins/prefetches
+// its manifest, and unpinned textures get evicted least-recently-used
+// first once resident bytes go over the budget. Images with byte-identical
+// pixels share a single texture.
+struct Stats {
+    size_t residentBytes = 0;
+    size_t residentCount = 0;
+    size_t atlasBytes = 0;
+    size_t pinnedCount = 0;
+    size_t pendingCount = 0;
+    size_t sharedCount = 0;  // resident images pointing at another image's identical texture
+    size_t sharedBytes = 0;  // VRAM those would have cost on their own
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+};
+
+void init(const std::string& imageDir);
+void shutdown();
+
+void setBudget(size_t bytes);
+size_t getBudget();
+
+// pin() also prefetches, so a state's manifest is resident before its first frame
+void pin(const std::vector<int>& ids);
+void unpin(const std::vector<int>& ids);
+// synchronous, but only decodes what a prefetchAsync() hasn't already started
+void prefetch(const std::vector<int>& ids);
+// decodes on the worker pool and uploads a little each update(), never blocks
+void prefetchAsync(const std::vector<int>& ids);
+void update();
+
+// called by Asset::render; loads synchronously on a miss
+void touch(Asset* asset);
+
+const Stats& getStats();
+
+} // namespace Residency
+} // namespace Assets
@@ -4,8 +4,10 @@
 #include <core/timer.hpp>
 
 #include <game/data.hpp>
+#include <game/residency.hpp>
 #include <core/input.hpp>
 #include <core/game.hpp>
+#include <core/rendering/renderQueue.hpp>
 
 #define AABB(x1, y1, w1, h1, x2, y2, w2, h2) \
     (x1 < x2 + w2 && x1 + w1 > x2 && y1 < y2 + h2 && y1 + h1 > y2)
@@ -13,7 +15,22 @@
 namespace game {
 namespace states {
 
+namespace {
+// every image this state draws, kept resident while it's active
+const std::vector<int> manifest = {
+    18, 19, 20, 203, 204, 205, 1150
+};
+
+const Assets::SoundId noseHonk = Assets::soundId("PartyFavorraspyPart_AC01__3");
+} // namespace
+
+void GameState::prefetch(Core::Game& /* game */) {
+    Assets::Residency::prefetchAsync(manifest);
+    Assets::prefetchSounds({ noseHonk });
+}
+
 void GameState::enter(Core::Game& /* game */) {
+    Assets::Residency::pin(manifest);
     // HITBOXES
     hitboxRightSLOW = Object(845-(int)362/2, 403-(int)822/2, &gx, &gy, 362, 822);
     hitboxLeftSLOW = Object(171-(int)362/2, 405-(int)822/2, &gx, &gy, 362, 822);
@@ -126,7 +143,7 @@ void GameState::update(Core::Game& g, float dt) {
         mouseX = g.convertMouseX(mouseX);
         mouseY = g.convertMouseY(mouseY);
         if (AABB(mouseX, mouseY, 1, 1, nose.getPosition(0), nose.getPosition(1), nose.width, nose.height) && Core::Input::get().justPressed("mouse_down")) {
-            Assets::playSound("PartyFavorraspyPart_AC01__3", 0);
+            Assets::play(noseHonk);
         }
     }
 
@@ -143,21 +160,23 @@ void GameState::update(Core::Game& g, float dt) {
 }
 
 void GameState::render(Core::Game& game) {
-    background.render();
+    using namespace Core::Rendering::RenderQueue;
+    background.submit(LAYER_BACKGROUND);
 
-    foreground.render();
-    nose.render();
-    fan.render();
+    foreground.submit(LAYER_WORLD, 0);
+    nose.submit(LAYER_WORLD, 1);
+    fan.submit(LAYER_WORLD, 2);
 
-    hitboxRightSLOW.render();
-    hitboxLeftSLOW.render();
-    hitboxRightFAST.render();
-    hitboxLeftFAST.render();
+    hitboxRightSLOW.submit(LAYER_DEBUG);
+    hitboxLeftSLOW.submit(LAYER_DEBUG);
+    hitboxRightFAST.submit(LAYER_DEBUG);
+    hitboxLeftFAST.submit(LAYER_DEBUG);
 
     //black.render();
 }
 
 void GameState::leave(Core::Game& /* game */) {
+    Assets::Residency::unpin(manifest);
 }
 
 } // namespace states
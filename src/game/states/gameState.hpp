@@ -8,7 +8,8 @@ namespace states {
 
 class GameState : public Core::State {
 public:
-    std::string state_name = "test";
+    GameState() { state_name = "game"; }
+    void prefetch(Core::Game& game) override;
     void enter(Core::Game& game) override;
     void handleEvents(Core::Game& game, SDL_Event& event) override;
     void update(Core::Game& game, float dt) override;
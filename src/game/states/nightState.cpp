@@ -4,6 +4,7 @@
 #include <core/timer.hpp>
 
 #include <game/data.hpp>
+#include <game/residency.hpp>
 
 #include <core/rendering/shapes.hpp>
 #include <core/rendering/colour.hpp>
@@ -15,9 +16,28 @@
 namespace game {
 namespace states {
 
-void NightState::enter(Core::Game& /* game */) {
-    Assets::stopAudio("titlemusic");
-    Assets::playSound("startday", 0);
+namespace {
+// every image this state draws, kept resident while it's active
+const std::vector<int> manifest = {
+    0, 430, 837, 838, 842, 843, 844, 1098, 1119, 1120, 1121, 1122, 1123, 1124, 1125, 1126, 1127,
+    1128, 1151
+};
+
+const Assets::SoundId startDaySound = Assets::soundId("startday");
+const Assets::SoundId titleMusic = Assets::soundId("titlemusic");
+} // namespace
+
+void NightState::prefetch(Core::Game& /* game */) {
+    Assets::Residency::prefetchAsync(manifest);
+    Assets::prefetchSounds({ startDaySound });
+}
+
+void NightState::enter(Core::Game& game) {
+    Assets::Residency::pin(manifest);
+    // the office loads while the night card is up
+    game.prefetchState<game::states::GameState>();
+    Assets::stopAll(titleMusic);
+    Assets::play(startDaySound);
     nightText = Object(Assets::assetList[0], 512, 374, &gx, &gy);
     switch(Data::night) {
         case 1:
@@ -128,6 +148,7 @@ void NightState::render(Core::Game& game) {
 }
 
 void NightState::leave(Core::Game& /* game */) {
+    Assets::Residency::unpin(manifest);
 }
 
 } // namespace states
@@ -8,7 +8,8 @@ namespace states {
 
 class NightState : public Core::State {
 public:
-    std::string state_name = "night";
+    NightState() { state_name = "night"; }
+    void prefetch(Core::Game& game) override;
     void enter(Core::Game& game) override;
     void handleEvents(Core::Game& game, SDL_Event& event) override;
     void update(Core::Game& game, float dt) override;
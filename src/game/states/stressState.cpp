@@ -0,0 +1,85 @@
+#include "stressState.hpp"
+
+#include <common/common.hpp>
+#include <core/helpers/random.hpp>
+#include <core/rendering/gl2d.hpp>
+#include <core/rendering/text.hpp>
+#include <core/timer.hpp>
+
+#include <game/residency.hpp>
+
+#include <cstdio>
+
+namespace game {
+namespace states {
+
+namespace {
+// small enough to be atlased, so most sprites end up sharing a texture
+constexpr int MAX_SPRITE_SIZE = 128;
+constexpr size_t MAX_SPRITE_KINDS = 16;
+} // namespace
+
+void StressState::enter(Core::Game& /* game */) {
+    Core::Helpers::initRandom();
+
+    for (int i = 0; i < Assets::MAX_ASSETS && m_manifest.size() < MAX_SPRITE_KINDS; ++i) {
+        Asset* asset = Assets::assetList[i];
+        if (asset && asset->width > 0 && asset->height > 0 &&
+            asset->width <= MAX_SPRITE_SIZE && asset->height <= MAX_SPRITE_SIZE) {
+            m_manifest.push_back(i);
+        }
+    }
+    if (m_manifest.empty()) return;
+    Assets::Residency::pin(m_manifest);
+
+    m_sprites.reserve(m_spriteCount);
+    for (int i = 0; i < m_spriteCount; ++i) {
+        Sprite sprite;
+        sprite.asset = Assets::assetList[m_manifest[i % m_manifest.size()]];
+        sprite.x = Core::Helpers::randFloat(0.0f, (float)Common::width);
+        sprite.y = Core::Helpers::randFloat(0.0f, (float)Common::height);
+        sprite.vx = Core::Helpers::randFloat(-200.0f, 200.0f);
+        sprite.vy = Core::Helpers::randFloat(-200.0f, 200.0f);
+        m_sprites.push_back(sprite);
+    }
+}
+
+void StressState::handleEvents(Core::Game& /* game */, SDL_Event& event) {
+    if (event.type != SDL_EVENT_KEY_DOWN || event.key.repeat) return;
+    if (event.key.scancode == SDL_SCANCODE_B) {
+        Core::Rendering::GL2D::setBatching(!Core::Rendering::GL2D::isBatching());
+    } else if (event.key.scancode == SDL_SCANCODE_I) {
+        Core::Rendering::GL2D::setInstancing(!Core::Rendering::GL2D::isInstancing());
+    }
+}
+
+void StressState::update(Core::Game& /* game */, float dt) {
+    for (auto& sprite : m_sprites) {
+        sprite.x += sprite.vx * dt;
+        sprite.y += sprite.vy * dt;
+        if (sprite.x < 0.0f || sprite.x > Common::width - sprite.asset->width) sprite.vx = -sprite.vx;
+        if (sprite.y < 0.0f || sprite.y > Common::height - sprite.asset->height) sprite.vy = -sprite.vy;
+    }
+}
+
+void StressState::render(Core::Game& /* game */) {
+    for (auto& sprite : m_sprites) {
+        sprite.asset->render((int)sprite.x, (int)sprite.y);
+    }
+
+    const auto& stats = Core::Rendering::GL2D::getFrameStats();
+    char buf[192];
+    std::snprintf(buf, sizeof(buf), "%zu sprites (%zu kinds), %.2f ms/frame | draws %zu, batches %zu | batching %s (B), instancing %s (I)",
+        m_sprites.size(), m_manifest.size(), Core::Timer::getDeltaTime() * 1000.0f,
+        stats.draws, stats.batches, Core::Rendering::GL2D::isBatching() ? "on" : "off",
+        Core::Rendering::GL2D::isInstancing() ? "on" : "off");
+    Core::Rendering::print(buf, 10, 40);
+}
+
+void StressState::leave(Core::Game& /* game */) {
+    if (!m_manifest.empty()) Assets::Residency::unpin(m_manifest);
+    m_sprites.clear();
+}
+
+} // namespace states
+} // namespace game
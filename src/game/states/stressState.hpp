@@ -0,0 +1,33 @@
+#pragma once
+#include <core/state.hpp>
+#include <game/asset.hpp>
+#include <vector>
+
+namespace game {
+namespace states {
+
+// --stress: thousands of small sprites bouncing around, for measuring the
+// renderer. B toggles batching so both paths can be compared.
+class StressState : public Core::State {
+public:
+    explicit StressState(int spriteCount = 10000) : m_spriteCount(spriteCount) { state_name = "stress"; }
+    void enter(Core::Game& game) override;
+    void handleEvents(Core::Game& game, SDL_Event& event) override;
+    void update(Core::Game& game, float dt) override;
+    void render(Core::Game& game) override;
+    void leave(Core::Game& game) override;
+
+private:
+    struct Sprite {
+        Asset* asset;
+        float x, y;
+        float vx, vy;
+    };
+
+    int m_spriteCount;
+    std::vector<int> m_manifest;
+    std::vector<Sprite> m_sprites;
+};
+
+} // namespace states
+} // namespace game
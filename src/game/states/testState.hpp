@@ -8,7 +8,7 @@ namespace states {
 
 class TestState : public Core::State {
 public:
-    std::string state_name = "test";
+    TestState() { state_name = "test"; }
     void enter(Core::Game& game) override;
     void handleEvents(Core::Game& game, SDL_Event& event) override;
     void update(Core::Game& game, float dt) override;
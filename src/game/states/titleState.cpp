@@ -7,10 +7,12 @@
 #include <core/rendering/shapes.hpp>
 #include <core/rendering/colour.hpp>
 #include <core/rendering/text.hpp>
+#include <core/rendering/renderQueue.hpp>
 
 #include <game/states/nightState.hpp>
 
 #include <game/data.hpp>
+#include <game/residency.hpp>
 
 #define AABB(x1, y1, w1, h1, x2, y2, w2, h2) \
     (x1 < x2 + w2 && x1 + w1 > x2 && y1 < y2 + h2 && y1 + h1 > y2)
@@ -18,7 +20,20 @@
 namespace game {
 namespace states {
 
+namespace {
+// every image this state draws, kept resident while it's active
+const std::vector<int> manifest = {
+    0, 33, 34, 35, 36, 37, 155, 160, 301, 592, 833, 849, 855, 859, 861, 862, 864, 1021, 1024, 1025,
+    1026, 1027, 1028, 1029, 1030, 1031, 1032, 1033, 1034, 1035, 1036, 1037, 1038, 1039, 1040, 1041,
+    1042, 1043
+};
+
+const Assets::SoundId selectSound = Assets::soundId("select");
+const Assets::SoundId confirmSound = Assets::soundId("confirm");
+} // namespace
+
 void TitleState::enter(Core::Game& /* game */) {
+    Assets::Residency::pin(manifest);
     Core::Helpers::initRandom();
     screenStatic = Object(
         Assets::assetList[34],
@@ -106,6 +121,8 @@ void TitleState::enter(Core::Game& /* game */) {
     holdDel = Object(Assets::assetList[1021], 376, 734, &gx, &gy);
     selector = Object(Assets::assetList[833], 54, 525, &gx, &gy);
 
+    for (Object* object : { &title, &newGame, &loadGame, &version, &copyright, &holdDel }) menuLayer.add(object);
+
     theTrap = Object(Assets::assetList[855], 0, 0, &gx, &gy);
     theTrap.blendMode = Core::Rendering::BlendMode::Custom;
     theTrap.srcFactor = GL_SRC_ALPHA;
@@ -247,21 +264,23 @@ void TitleState::update(Core::Game& g, float dt) {
 
         if (AABB(mx, my, 1, 1, newGame.getPosition(0), newGame.getPosition(1), newGame.width, newGame.height)) {
             if (selector.x != newGame.x)
-                ::Assets::playSound("select", 0);
+                ::Assets::play(selectSound, 0, ::Assets::PRIORITY_UI);
             selector.x = newGame.x;
         } else if (AABB(mx, my, 1, 1, loadGame.getPosition(0), loadGame.getPosition(1), loadGame.width, loadGame.height)) {
             if (selector.x != loadGame.x)
-                ::Assets::playSound("select", 0);
+                ::Assets::play(selectSound, 0, ::Assets::PRIORITY_UI);
             selector.x = loadGame.x;
         }
 
         if (Core::Input::get().justPressed("mouse_down")) {
             if (AABB(mx, my, 1, 1, newGame.getPosition(0), newGame.getPosition(1), newGame.width, newGame.height)) {
-                ::Assets::playSound("confirm", 0);
+                ::Assets::play(confirmSound, 0, ::Assets::PRIORITY_UI);
                 state = 1;
+                g.prefetchState<game::states::NightState>();
             } else if (AABB(mx, my, 1, 1, loadGame.getPosition(0), loadGame.getPosition(1), loadGame.width, loadGame.height)) {
-                ::Assets::playSound("confirm", 0);
+                ::Assets::play(confirmSound, 0, ::Assets::PRIORITY_UI);
                 state = 1;
+                g.prefetchState<game::states::NightState>();
             }
         }
 
@@ -296,38 +315,32 @@ void TitleState::render(Core::Game& game) {
     Core::Rendering::Shapes::rectangle(false, 0, 0, 1024, 768);
     Core::Rendering::setColor(1.0f, 1.0f, 1.0f, 1.0f);
 
+    using namespace Core::Rendering::RenderQueue;
     if (state < 2) {
-        theTrap.render();
-
-        lineLeft1.render();
-        lineLeft2.render();
-        lineLeft3.render();
-        lineLeft4.render();
-        lineLeft5.render();
-        lineLeft6.render();
-        lineLeft7.render();
-        lineLeft8.render();
-        lineLeft9.render();
-
-        title.render();
-        newGame.render();
-        loadGame.render();
-        version.render();
-        copyright.render();
-        holdDel.render();
-        selector.render();
-
-        screenStatic.render();
+        theTrap.submit(LAYER_BACKGROUND);
+
+        // the lines overlap, keep them in order
+        Object* lines[] = { &lineLeft1, &lineLeft2, &lineLeft3, &lineLeft4, &lineLeft5,
+                            &lineLeft6, &lineLeft7, &lineLeft8, &lineLeft9 };
+        for (uint16_t i = 0; i < 9; ++i) lines[i]->submit(LAYER_WORLD, i);
+
+        // one cached quad for the static menu text; the selector moves and
+        // overlaps loadGame, so it gets its own depth to stay on top
+        menuLayer.submit(LAYER_UI, 0);
+        selector.submit(LAYER_UI, 1);
+
+        screenStatic.submit(LAYER_OVERLAY, 0);
     }
 
-    freddyFuckingNewspaper.render();
+    freddyFuckingNewspaper.submit(LAYER_OVERLAY, 1);
 
     char buf[32];
     std::snprintf(buf, sizeof(buf), "Target Night: %d", ::Data::night);
-    Core::Rendering::print(buf, 10, 50);
+    submit(LAYER_DEBUG, 0, [text = std::string(buf)] { Core::Rendering::print(text, 10, 50); });
 }
 
 void TitleState::leave(Core::Game& /* game */) {
+    Assets::Residency::unpin(manifest);
 }
 
 } // namespace states
@@ -2,6 +2,7 @@
 
 #include <core/state.hpp>
 #include <game/gameObject.hpp>
+#include <game/cachedLayer.hpp>
 #include <game/asset.hpp>
 #include <core/helpers/random.hpp>
 #include <vector>
@@ -11,7 +12,7 @@ namespace states {
 
 class TitleState : public Core::State {
 public:
-    std::string state_name = "title";
+    TitleState() { state_name = "title"; }
     void enter(Core::Game& game) override;
     void handleEvents(Core::Game& game, SDL_Event& event) override;
     void update(Core::Game& game, float dt) override;
@@ -40,6 +41,8 @@ private:
     Object copyright;
     Object holdDel;
     Object selector;
+    // title, menu entries and footer text, static while the menu is up
+    CachedLayer menuLayer{ "title menu" };
     Object theTrap;
     
     Object freddyFuckingNewspaper;
@@ -1,4 +1,9 @@
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
 #include <iostream>
+#include <vector>
 
 #include <SDL3/SDL.h>
 
@@ -9,10 +14,40 @@
 #include <core/input.hpp>
 
 #include <core/rendering/text.hpp>
+#include <core/rendering/gl2d.hpp>
 
 #include <game/states/titleState.hpp>
+#include <game/states/stressState.hpp>
 
 #include <game/asset.hpp>
+#include <game/residency.hpp>
+
+// the whole argument has to be a number, so "--frames 10x" isn't quietly 10
+template <typename T>
+static bool parseNumber(const char* text, T& value) {
+    const char* end = text + std::strlen(text);
+    auto [ptr, ec] = std::from_chars(text, end, value);
+    return ec == std::errc() && ptr == end;
+}
+
+// min / mean / percentiles of a headless run, one line each
+static void reportFrameTimes(std::vector<double> ms, double seconds) {
+    if (ms.empty()) {
+        std::cout << "Headless: no frames rendered" << std::endl;
+        return;
+    }
+    std::sort(ms.begin(), ms.end());
+    double sum = 0.0;
+    for (double m : ms) sum += m;
+    auto pct = [&](double p) { return ms[std::min(ms.size() - 1, (size_t)(p * (ms.size() - 1) + 0.5))]; };
+
+    char buf[256];
+    std::snprintf(buf, sizeof(buf), "Headless: %zu frames in %.2f s (%.1f fps)", ms.size(), seconds, ms.size() / seconds);
+    std::cout << buf << std::endl;
+    std::snprintf(buf, sizeof(buf), "Frame ms: min %.3f  mean %.3f  p50 %.3f  p95 %.3f  p99 %.3f  max %.3f",
+        ms.front(), sum / ms.size(), pct(0.50), pct(0.95), pct(0.99), ms.back());
+    std::cout << buf << std::endl;
+}
 
 int main(int argc, char** argv) {
     Core::Game& game = Core::Game::getInstance();
@@ -23,14 +58,73 @@ int main(int argc, char** argv) {
         Common::getBuildType().c_str()
     );
 
+    bool benchMixer = false;
+    bool benchVertex = false;
+    bool stress = false;
+    bool headless = false;
+    int headlessFrames = 0;
+    double headlessSeconds = 0.0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--vram-budget" && i + 1 < argc) {
+            size_t megabytes = 0;
+            if (!parseNumber(argv[++i], megabytes)) {
+                std::cerr << "Invalid value for --vram-budget: " << argv[i] << " (expected megabytes)" << std::endl;
+                return 1;
+            }
+            Assets::Residency::setBudget(megabytes * 1024 * 1024);
+        } else if (arg == "--no-audio-streaming") {
+            Assets::streamAudio = false;
+        } else if (arg == "--no-audio-normalize") {
+            Assets::normalizeAudio = false;
+        } else if (arg == "--bench-mixer") {
+            benchMixer = true;
+        } else if (arg == "--bench-vertex") {
+            benchVertex = true;
+        } else if (arg == "--stress") {
+            stress = true;
+        } else if (arg == "--headless") {
+            headless = true;
+        } else if (arg == "--frames" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], headlessFrames)) {
+                std::cerr << "Invalid value for --frames: " << argv[i] << " (expected a frame count)" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--duration" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], headlessSeconds)) {
+                std::cerr << "Invalid value for --duration: " << argv[i] << " (expected seconds)" << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    // a headless run stops by itself, 600 frames unless told otherwise
+    if (headless && headlessFrames <= 0 && headlessSeconds <= 0.0) headlessFrames = 600;
+    game.setHeadless(headless);
+
     if (game.init(titleBuffer, 1024, 768) != 0) {
         std::cerr << "Failed to initialize game." << std::endl;
         return -1;
     }
 
+    if (benchVertex) {
+        int result = Core::Rendering::GL2D::benchmarkVertexFormats();
+        game.cleanup();
+        return result;
+    }
+
+    // CI has no sound card either
+    if (headless) SDL_SetHint(SDL_HINT_AUDIO_DRIVER, "dummy");
     Assets::initAudio();
     Assets::loadAllAssets();
-    game.changeState<game::states::TitleState>();
+    if (benchMixer) {
+        int result = Assets::benchmarkMixer();
+        game.cleanup();
+        Assets::unloadAllAssets();
+        return result;
+    }
+    if (stress) game.changeState<game::states::StressState>();
+    else game.changeState<game::states::TitleState>();
 
     auto& input = Core::Input::get();
     input.addAction("confirm");
@@ -46,15 +140,34 @@ int main(int argc, char** argv) {
 
     Core::Rendering::loadFont("default", "assets/fonts/DejaVuLGCSansMono.ttf", 16);
 
+    using Clock = std::chrono::steady_clock;
+    std::vector<double> frameMs;
+    if (headless) frameMs.reserve(headlessFrames > 0 ? headlessFrames : 4096);
+    auto runStart = Clock::now();
+
     while (game.isRunning()) {
+        auto frameStart = Clock::now();
         Core::Timer::tick();
         Assets::updateAudio();
+        Assets::Residency::update();
         game.handleEvents();
         game.update();
         game.render();
+
+        if (headless) {
+            auto now = Clock::now();
+            frameMs.push_back(std::chrono::duration<double, std::milli>(now - frameStart).count());
+            double elapsed = std::chrono::duration<double>(now - runStart).count();
+            if ((headlessFrames > 0 && (int)frameMs.size() >= headlessFrames) ||
+                (headlessSeconds > 0.0 && elapsed >= headlessSeconds)) {
+                reportFrameTimes(std::move(frameMs), elapsed);
+                break;
+            }
+        }
     }
 
     game.cleanup();
+    Assets::unloadAllAssets();
 
     return 0;
 }
@@ -0,0 +1,88 @@
+// Packs assets/images and assets/audio into a single assets.pack
+// usage: fnaf3-pack <assets dir> <output file>
+
+#include <common/pack.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static bool readFile(const fs::path& path, std::vector<unsigned char>& out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    out.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return true;
+}
+
+// already compressed formats never get under the deflate threshold, don't bother trying
+static bool worthDeflating(const fs::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    return ext != ".png" && ext != ".jpg" && ext != ".ogg" && ext != ".mp3";
+}
+
+static std::vector<fs::path> listFiles(const fs::path& dir) {
+    std::vector<fs::path> files;
+    if (!fs::is_directory(dir)) return files;
+    for (const auto& entry : fs::directory_iterator(dir)) {
+        if (entry.is_regular_file()) files.push_back(entry.path());
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+static bool addFile(Common::PackWriter& writer, Common::Pack::Type type, int id, const fs::path& path) {
+    std::vector<unsigned char> data;
+    if (!readFile(path, data)) {
+        std::cerr << "Failed to read " << path.string() << "\n";
+        return false;
+    }
+    int64_t sourceTime = (int64_t)fs::last_write_time(path).time_since_epoch().count();
+    writer.add(type, id, path.filename().string(), sourceTime, data, worthDeflating(path));
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::cerr << "usage: " << argv[0] << " <assets dir> <output file>\n";
+        return 1;
+    }
+
+    fs::path assetDir = argv[1];
+    Common::PackWriter writer;
+    size_t images = 0, sounds = 0;
+
+    for (const auto& path : listFiles(assetDir / "images")) {
+        int id = -1;
+        try {
+            id = std::stoi(path.stem().string());
+        } catch (...) {
+            std::cerr << "Skipping image without a numeric name: " << path.string() << "\n";
+            continue;
+        }
+        if (!addFile(writer, Common::Pack::Type::Image, id, path)) return 1;
+        ++images;
+    }
+
+    // sounds are looked up by name, ids are just their position in name order
+    int soundId = 0;
+    for (const auto& path : listFiles(assetDir / "audio")) {
+        if (!addFile(writer, Common::Pack::Type::Audio, soundId++, path)) return 1;
+        ++sounds;
+    }
+
+    if (!writer.write(argv[2])) {
+        std::cerr << "Failed to write " << argv[2] << "\n";
+        return 1;
+    }
+
+    std::cout << "Packed " << images << " images and " << sounds << " sounds into " << argv[2]
+              << " (" << writer.getStoredBytes() / 1024 << " KB, " << writer.getRawBytes() / 1024 << " KB unpacked)\n";
+    return 0;
+}